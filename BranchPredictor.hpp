@@ -2,124 +2,162 @@
 #define __BRANCH_PREDICTOR_HPP__
 
 #include <vector>
-#include <bitset>
+#include <cstdint>
 #include<cassert>
+#include<memory>
 #include<random>
+#include "Checkpoint.hpp"
 
 using namespace std;
 
-struct BranchPredictor {
-    virtual bool predict(uint32_t pc) = 0;
-    virtual void update(uint32_t pc, bool taken) = 0;
+// table of Bits wide values packed into 64-bit words, the saturating counters of the predictors and their history registers
+template <int Bits = 2>
+struct CounterTable {
+    static_assert(Bits >= 1 && Bits <= 32, "a value has to fit into a word");
+    static constexpr uint32_t PER_WORD = 64 / Bits;
+    static constexpr uint32_t MAX = (uint32_t)((1ULL << Bits) - 1);
+    std::vector<uint64_t> words;
+
+    CounterTable(size_t size, int value) : words((size + PER_WORD - 1) / PER_WORD) {
+        uint64_t word = 0;
+        for (uint32_t i = 0; i < PER_WORD; ++i)
+            word |= (uint64_t)(value & MAX) << (Bits * i);
+        for (auto &w : words)
+            w = word;
+    }
+
+    uint32_t get(uint32_t i) const {
+        return words[i / PER_WORD] >> (Bits * (i % PER_WORD)) & MAX;
+    }
+
+    void set(uint32_t i, uint32_t value) {
+        uint32_t shift = Bits * (i % PER_WORD);
+        words[i / PER_WORD] ^= (uint64_t)(get(i) ^ value) << shift;
+    }
+
+    // counters with the top bit set predict taken
+    bool taken(uint32_t i) const {
+        return words[i / PER_WORD] >> (Bits * (i % PER_WORD) + Bits - 1) & 1;
+    }
+
+    // count towards taken or not taken without branches, saturating at MAX and 0
+    void update(uint32_t i, bool taken) {
+        uint32_t shift = Bits * (i % PER_WORD);
+        uint32_t counter = words[i / PER_WORD] >> shift & MAX;
+        uint32_t next = counter + (taken & (counter != MAX)) - (!taken & (counter != 0));
+        words[i / PER_WORD] ^= (uint64_t)(counter ^ next) << shift;
+    }
+
+    // shift the outcome into a Bits long history
+    void shift(uint32_t i, bool taken) {
+        set(i, (get(i) << 1 | taken) & MAX);
+    }
+
+    template <typename Archive>
+    void transfer(Archive &a) {
+        a.field(words);
+    }
 };
 
-struct SaturatingBranchPredictor : public BranchPredictor {
-    std::vector<std::bitset<2>> table;
+// kind and parameters of a predictor, a checkpoint is only restored into a predictor of the same geometry
+constexpr uint64_t predictorGeometry(int kind, int indexBits, int historyBits, int counterBits, uint32_t size = 0) {
+    return (uint64_t)kind << 56 | (uint64_t)indexBits << 48 | (uint64_t)historyBits << 40 | (uint64_t)counterBits << 32 | size;
+}
 
-    SaturatingBranchPredictor(int value) : table(1 << 14, value) {}
+/*
+    the predictors are policies with non-virtual predict and update, so that a simulator templated on one
+    inlines them; the geometry is given by template parameters: IndexBits low bits of the pc index the tables,
+    HistoryBits outcomes are kept in a history and every counter is CounterBits wide
+*/
+template <int IndexBits = 14, int CounterBits = 2>
+struct SaturatingPredictor {
+    static constexpr uint32_t INDEX_MASK = (1u << IndexBits) - 1;
+    CounterTable<CounterBits> table;
+
+    SaturatingPredictor(int value) : table(1 << IndexBits, value) {}
 
     bool predict(uint32_t pc) {
-        // your code here
-        uint32_t lsb14=(pc & (uint32_t)((1<<14)-1));
-        if(table[lsb14]==bitset<2>(2) || table[lsb14]==bitset<2>(3)) return true;
-        else return false;
+        return table.taken(pc & INDEX_MASK);
     }
 
     void update(uint32_t pc, bool taken) {
-        // your code here
-        uint32_t lsb14=(pc & (uint32_t)((1<<14)-1));
-        if(taken)
-        {
-            if(table[lsb14]==bitset<2>(0)) table[lsb14]=bitset<2>(1);
-            else if(table[lsb14]==bitset<2>(1)) table[lsb14]=bitset<2>(2);
-            else if(table[lsb14]==bitset<2>(2)) table[lsb14]=bitset<2>(3);
-        }
-        else
-        {
-            if(table[lsb14]==bitset<2>(1)) table[lsb14]=bitset<2>(0);
-            else if(table[lsb14]==bitset<2>(2)) table[lsb14]=bitset<2>(1);
-            else if(table[lsb14]==bitset<2>(3)) table[lsb14]=bitset<2>(2);
-        }
+        table.update(pc & INDEX_MASK, taken);
+    }
+
+    uint64_t geometry() const {
+        return predictorGeometry(1, IndexBits, 0, CounterBits);
+    }
+
+    template <typename Archive>
+    void transfer(Archive &a) {
+        table.transfer(a);
     }
 };
 
-struct BHRBranchPredictor : public BranchPredictor {
-    std::vector<std::bitset<2>> bhrTable;
-    std::bitset<2> bhr;
-    BHRBranchPredictor(int value) : bhrTable(1 << 2, value), bhr(value) {}
+template <int HistoryBits = 2, int CounterBits = 2>
+struct BHRPredictor {
+    static constexpr uint32_t HISTORY_MASK = (1u << HistoryBits) - 1;
+    CounterTable<CounterBits> bhrTable;
+    uint32_t bhr;
+    BHRPredictor(int value) : bhrTable(1 << HistoryBits, value), bhr(value & HISTORY_MASK) {}
 
-    bool predict(uint32_t pc) {
-        // your code here
-        int val=(int)(bhr.to_ulong());
-        if(bhrTable[val]==bitset<2>(2) || bhrTable[val]==bitset<2>(3)) return true;
-        else return false;
+    bool predict(uint32_t /*pc*/) {
+        return bhrTable.taken(bhr);
     }
 
-    void update(uint32_t pc, bool taken) {
-        // your code here
-        int val=(int)(bhr.to_ulong());
-        if(taken)
-        {
-            if(bhrTable[val]==bitset<2>(0)) bhrTable[val]=bitset<2>(1);
-            else if(bhrTable[val]==bitset<2>(1)) bhrTable[val]=bitset<2>(2);
-            else if(bhrTable[val]==bitset<2>(2)) bhrTable[val]=bitset<2>(3);
-        }
-        else
-        {
-            if(bhrTable[val]==bitset<2>(1)) bhrTable[val]=bitset<2>(0);
-            else if(bhrTable[val]==bitset<2>(2)) bhrTable[val]=bitset<2>(1);
-            else if(bhrTable[val]==bitset<2>(3)) bhrTable[val]=bitset<2>(2);
-        }
-        val=val%2;
-        val=val*2;
-        if(taken) val+=1;
-        bhr=bitset<2>(val);
+    void update(uint32_t /*pc*/, bool taken) {
+        bhrTable.update(bhr,taken);
+        bhr=(bhr << 1 | taken) & HISTORY_MASK;
+    }
+
+    uint64_t geometry() const {
+        return predictorGeometry(2, 0, HistoryBits, CounterBits);
+    }
+
+    template <typename Archive>
+    void transfer(Archive &a) {
+        bhrTable.transfer(a);
+        a.field(bhr);
     }
 };
 
-struct SaturatingBHRBranchPredictor : public BranchPredictor {
-    std::vector<std::bitset<2>> bhrTable;
-    std::bitset<2> bhr;
-    std::vector<std::bitset<2>> table;
-    std::vector<std::bitset<2>> combination;
-    SaturatingBHRBranchPredictor(int value, int size) : bhrTable(1 << 2, value), bhr(value), table(1 << 14, value), combination(size, value) {
-        assert(size <= (1 << 16));
+// the counter is selected by the pc together with the history of the branches at that pc
+template <int IndexBits = 14, int HistoryBits = 2, int CounterBits = 2>
+struct SaturatingBHRPredictor {
+    static constexpr uint32_t INDEX_MASK = (1u << IndexBits) - 1;
+    CounterTable<CounterBits> bhrTable;
+    uint32_t bhr;
+    CounterTable<HistoryBits> table;
+    CounterTable<CounterBits> combination;
+    SaturatingBHRPredictor(int value, int size) : bhrTable(1 << HistoryBits, value), bhr(value & ((1u << HistoryBits) - 1)), table(1 << IndexBits, value), combination(size, value) {
+        assert(size <= (1 << (IndexBits + HistoryBits)));
     }
 
     //STRATEGY 1
 
     bool predict(uint32_t pc)
     {
-        //your code here
-        uint32_t lsb14=(pc & (uint32_t)((1<<14)-1));
-        int val=4*((int)lsb14)+(int)(table[lsb14].to_ulong());
-        if(combination[val]==bitset<2>(2) || combination[val]==bitset<2>(3)) return true;
-        else return false;
+        uint32_t index=pc & INDEX_MASK;
+        return combination.taken((index << HistoryBits)+table.get(index));
     }
 
     void update(uint32_t pc,bool taken)
     {
-        //your code here
-        uint32_t lsb14=(pc & (uint32_t)((1<<14)-1));
-        int val=4*lsb14+(int)(table[lsb14].to_ulong());
-        if(taken)
-        {
-            if(combination[val]==bitset<2>(0)) combination[val]=bitset<2>(1);
-            else if(combination[val]==bitset<2>(1)) combination[val]=bitset<2>(2);
-            else if(combination[val]==bitset<2>(2)) combination[val]=bitset<2>(3);
-        }
-        else
-        {
-            if(combination[val]==bitset<2>(1)) combination[val]=bitset<2>(0);
-            else if(combination[val]==bitset<2>(2)) combination[val]=bitset<2>(1);
-            else if(combination[val]==bitset<2>(3)) combination[val]=bitset<2>(2);
-        }
-        
-        int num=(int)(table[lsb14].to_ulong());
-        num=num%2;
-        num=num*2;
-        if(taken) num+=1;
-        table[lsb14]=bitset<2>(num);
+        uint32_t index=pc & INDEX_MASK;
+        combination.update((index << HistoryBits)+table.get(index),taken);
+        table.shift(index,taken);
+    }
+
+    uint64_t geometry() const {
+        return predictorGeometry(3, IndexBits, HistoryBits, CounterBits, combination.words.size());
+    }
+
+    template <typename Archive>
+    void transfer(Archive &a) {
+        bhrTable.transfer(a);
+        a.field(bhr);
+        table.transfer(a);
+        combination.transfer(a);
     }
 
     // STRATEGY 2
@@ -236,4 +274,54 @@ struct SaturatingBHRBranchPredictor : public BranchPredictor {
 
 };
 
-#endif
\ No newline at end of file
+struct BranchPredictor {
+    virtual bool predict(uint32_t pc) = 0;
+    virtual void update(uint32_t pc, bool taken) = 0;
+    virtual ~BranchPredictor() = default;
+};
+
+// implemented by the predictors of this file, so that the simulators copy their tables into snapshots and checkpoint files;
+// a snapshot shares any other predictor with the run and a checkpoint file taken with one is not resumed
+struct CheckpointablePredictor {
+    virtual std::shared_ptr<BranchPredictor> clone() const = 0;
+    virtual uint64_t geometry() const = 0;
+    virtual void transfer(CheckpointWriter &a) = 0;
+    virtual void transfer(CheckpointReader &a) = 0;
+    virtual ~CheckpointablePredictor() = default;
+};
+
+// the virtual interface over a predictor policy, for the code choosing the predictor at run time
+template <class Predictor>
+struct VirtualPredictor : public BranchPredictor, public CheckpointablePredictor, public Predictor {
+    using Predictor::Predictor;
+
+    bool predict(uint32_t pc) {
+        return Predictor::predict(pc);
+    }
+
+    void update(uint32_t pc, bool taken) {
+        Predictor::update(pc, taken);
+    }
+
+    std::shared_ptr<BranchPredictor> clone() const {
+        return std::make_shared<VirtualPredictor>(*this);
+    }
+
+    uint64_t geometry() const {
+        return Predictor::geometry();
+    }
+
+    void transfer(CheckpointWriter &a) {
+        Predictor::transfer(a);
+    }
+
+    void transfer(CheckpointReader &a) {
+        Predictor::transfer(a);
+    }
+};
+
+typedef VirtualPredictor<SaturatingPredictor<>> SaturatingBranchPredictor;
+typedef VirtualPredictor<BHRPredictor<>> BHRBranchPredictor;
+typedef VirtualPredictor<SaturatingBHRPredictor<>> SaturatingBHRBranchPredictor;
+
+#endif
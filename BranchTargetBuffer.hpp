@@ -0,0 +1,122 @@
+/**
+ * @file BranchTargetBuffer.hpp
+ * branch target buffer of the fetch stage of the pipelined simulators
+ */
+
+#ifndef __BRANCH_TARGET_BUFFER_HPP__
+#define __BRANCH_TARGET_BUFFER_HPP__
+
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+/*
+	set associative table of the targets of j, beq and bne, tagged by the index of the command and replaced
+	LRU. Only the control commands look it up, so the hit rate is the share of them fetch found a target for.
+	Without entries it is disabled.
+*/
+struct BranchTargetBuffer
+{
+	int ways = 1, setMask = -1;
+	// command index + 1 of every way (0 for an empty way), its target and its last use
+	std::vector<int> tags, targets;
+	std::vector<uint64_t> stamps;
+	// removed: ID cycles left idle by a j redirecting fetch from the ALU stage, which hits saved for the j not squashed
+	uint64_t time = 0, hits = 0, misses = 0, removed = 0;
+
+	// entries and associativity powers of two
+	void configure(int entries, int associativity)
+	{
+		ways = associativity < entries ? associativity : entries;
+		setMask = entries / ways - 1;
+		tags.assign(entries, 0);
+		targets.assign(entries, 0);
+		stamps.assign(entries, 0);
+		time = hits = misses = removed = 0;
+	}
+
+	bool enabled() const
+	{
+		return !tags.empty();
+	}
+
+	// way holding the command, -1 on a miss; nothing is counted or changed
+	int find(int pc) const
+	{
+		int base = (pc & setMask) * ways;
+		for (int i = base; i < base + ways; ++i)
+			if (tags[i] == pc + 1)
+				return i;
+		return -1;
+	}
+
+	// target of the command fetched at pc, -1 on a miss
+	int lookup(int pc)
+	{
+		++time;
+		int way = find(pc);
+		if (way < 0)
+		{
+			++misses;
+			return -1;
+		}
+		++hits;
+		stamps[way] = time;
+		return targets[way];
+	}
+
+	// record the target of a taken command, in the least recently used way of its set
+	void insert(int pc, int target)
+	{
+		++time;
+		int way = find(pc);
+		if (way < 0)
+		{
+			int base = (pc & setMask) * ways;
+			way = base;
+			for (int i = base; i < base + ways; ++i)
+				if (stamps[i] < stamps[way])
+					way = i;
+			tags[way] = pc + 1;
+		}
+		targets[way] = target;
+		stamps[way] = time;
+	}
+
+	// forget a branch that was not taken
+	void erase(int pc)
+	{
+		int way = find(pc);
+		if (way >= 0)
+			tags[way] = 0, stamps[way] = 0;
+	}
+
+	double hitRate() const
+	{
+		return hits + misses == 0 ? 0 : (double)hits / (hits + misses);
+	}
+
+	void report(std::ostream &out)
+	{
+		out << "BTB: " << hits << " hits, " << misses << " misses, hit rate " << std::fixed << std::setprecision(2) << 100 * hitRate() << "%, "
+			<< removed << " bubbles removed by jumps redirected in fetch\n"
+			<< std::defaultfloat;
+	}
+
+	bool sameGeometry(const BranchTargetBuffer &other) const
+	{
+		return tags.size() == other.tags.size() && ways == other.ways && targets.size() == tags.size() && stamps.size() == tags.size();
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(tags);
+		a.field(targets);
+		a.field(stamps);
+		a.field(time), a.field(hits), a.field(misses), a.field(removed);
+	}
+};
+
+#endif
@@ -0,0 +1,429 @@
+/**
+ * @file Cache.hpp
+ * set associative cache hierarchy timing model for the pipelined simulators
+ */
+
+#ifndef __CACHE_HPP__
+#define __CACHE_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Dram.hpp"
+#include "Prefetcher.hpp"
+
+enum Replacement
+{
+	LRU,
+	FIFO,
+	RANDOM
+};
+
+// size and line size in bytes, all three sizes powers of two; hitLatency in cycles
+struct CacheConfig
+{
+	int size = 1 << 15, associativity = 8, lineSize = 64, hitLatency = 1;
+	Replacement replacement = LRU;
+
+	bool operator==(const CacheConfig &other) const
+	{
+		return size == other.size && associativity == other.associativity && lineSize == other.lineSize &&
+			   hitLatency == other.hitLatency && replacement == other.replacement;
+	}
+};
+
+/*
+	tags of a set associative cache, only the timing is modelled: the data stays in the simulator
+	memory. Writes allocate like reads and evictions cost nothing, i.e. write-back with free write-backs.
+	The ways of a set are contiguous so a lookup touches a single cache line of the host.
+*/
+struct Cache
+{
+	CacheConfig config;
+	int ways, lineBits, setMask;
+	// line address + 1 of every way (0 for an empty way), its last use (LRU) or fill (FIFO) time and,
+	// for a prefetched line not used yet, the cycle its fill arrives (-1 otherwise)
+	std::vector<uint32_t> tags;
+	std::vector<uint64_t> stamps;
+	std::vector<int64_t> prefetched;
+	uint64_t time = 0, hits = 0, misses = 0;
+	uint32_t random = 2463534242u;
+
+	Cache(const CacheConfig &config = CacheConfig()) : config(config), ways(config.associativity)
+	{
+		lineBits = 0;
+		while ((1 << lineBits) < config.lineSize)
+			++lineBits;
+		int sets = config.size / (config.lineSize * ways);
+		setMask = (sets > 0 ? sets : 1) - 1;
+		tags.assign((setMask + 1) * ways, 0);
+		stamps.assign(tags.size(), 0);
+		prefetched.assign(tags.size(), -1);
+	}
+
+	// way holding the byte address, -1 on a miss; nothing is counted or changed
+	int lookup(uint32_t address) const
+	{
+		uint32_t line = address >> lineBits;
+		int base = (line & setMask) * ways;
+		for (int i = base; i < base + ways; ++i)
+			if (tags[i] == line + 1)
+				return i;
+		return -1;
+	}
+
+	bool probe(uint32_t address) const
+	{
+		return lookup(address) >= 0;
+	}
+
+	// put the line of the byte address into the way chosen by the replacement policy and return the way
+	int fill(uint32_t address)
+	{
+		uint32_t line = address >> lineBits;
+		int base = (line & setMask) * ways, victim = base;
+		if (config.replacement == RANDOM)
+		{
+			random ^= random << 13, random ^= random >> 17, random ^= random << 5;
+			victim = base + random % ways;
+		}
+		else
+			for (int i = base; i < base + ways; ++i)
+				if (stamps[i] < stamps[victim])
+					victim = i;
+		tags[victim] = line + 1;
+		stamps[victim] = time;
+		prefetched[victim] = -1;
+		return victim;
+	}
+
+	// look the byte address up and fill its line on a miss, true on a hit
+	bool access(uint32_t address)
+	{
+		++time;
+		int way = lookup(address);
+		if (way < 0)
+		{
+			++misses;
+			fill(address);
+			return false;
+		}
+		++hits;
+		if (config.replacement == LRU)
+			stamps[way] = time;
+		return true;
+	}
+
+	double hitRate() const
+	{
+		return hits + misses == 0 ? 0 : (double)hits / (hits + misses);
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(config);
+		a.field(tags);
+		a.field(stamps);
+		a.field(prefetched);
+		a.field(time), a.field(hits), a.field(misses), a.field(random);
+	}
+};
+
+/*
+	miss status holding registers of a non-blocking cache: an entry per line being filled, which
+	later misses to the same line merge into. Every cycle with fills outstanding adds their number
+	to the memory level parallelism statistics.
+*/
+struct MissStatusRegisters
+{
+	struct Entry
+	{
+		uint32_t line;
+		int64_t ready;
+	};
+	// 0 makes the cache blocking
+	int capacity = 0;
+	std::vector<Entry> entries;
+	uint64_t allocations = 0, merges = 0, fullStalls = 0, busyCycles = 0, outstanding = 0, peak = 0;
+
+	Entry *find(uint32_t line)
+	{
+		for (Entry &entry : entries)
+			if (entry.line == line)
+				return &entry;
+		return nullptr;
+	}
+
+	bool full() const
+	{
+		return (int)entries.size() >= capacity;
+	}
+
+	// retire the fills done by the given cycle and count the ones still outstanding
+	void tick(int64_t now)
+	{
+		entries.erase(std::remove_if(entries.begin(), entries.end(), [now](const Entry &entry)
+									 { return entry.ready <= now; }),
+					  entries.end());
+		if (entries.empty())
+			return;
+		++busyCycles;
+		outstanding += entries.size();
+		peak = std::max(peak, (uint64_t)entries.size());
+	}
+
+	// average number of fills outstanding while any is
+	double parallelism() const
+	{
+		return busyCycles == 0 ? 0 : (double)outstanding / busyCycles;
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(capacity);
+		a.field(entries);
+		a.field(allocations), a.field(merges), a.field(fullStalls), a.field(busyCycles), a.field(outstanding), a.field(peak);
+	}
+};
+
+/*
+	usefulness of the prefetches: accuracy is the share of the prefetched lines used by a demand
+	access, coverage the share of the demand misses they removed and timeliness the share of the
+	used ones which arrived before their first use
+*/
+struct PrefetchStatistics
+{
+	uint64_t issued = 0, useful = 0, timely = 0, demandMisses = 0;
+
+	double accuracy() const { return issued == 0 ? 0 : (double)useful / issued; }
+	double coverage() const { return useful + demandMisses == 0 ? 0 : (double)useful / (useful + demandMisses); }
+	double timeliness() const { return useful == 0 ? 0 : (double)timely / useful; }
+};
+
+/*
+	split first level caches in front of a unified second level and main memory, which takes a fixed
+	latency or, with useDram, goes through the DRAM controller model. The optional prefetcher is
+	trained on the data accesses and fills the first level data cache.
+	Accesses return the cycle in which their data is ready. A DRAM access is only timed once the
+	controller schedules it: until then it is PENDING and its waiter polls resolve every cycle.
+*/
+struct CacheHierarchy
+{
+	static constexpr int64_t PENDING = INT64_MAX;
+
+	// a second level line being read from the DRAM
+	struct Fill
+	{
+		uint32_t line;
+		int64_t ready;
+	};
+
+	Cache l1i, l1d, l2;
+	int memoryLatency;
+	MissStatusRegisters mshrs;
+	DataPrefetcher prefetcher;
+	PrefetchStatistics prefetch;
+	std::vector<uint32_t> prefetches;
+	bool useDram = false;
+	DramController dram;
+	std::vector<Fill> fills;
+	std::vector<std::pair<uint32_t, int64_t>> scheduled;
+
+	CacheHierarchy(const CacheConfig &l1i = CacheConfig(), const CacheConfig &l1d = CacheConfig(),
+				   const CacheConfig &l2 = {1 << 18, 8, 64, 10, LRU}, int memoryLatency = 100)
+		: l1i(l1i), l1d(l1d), l2(l2), memoryLatency(memoryLatency) {}
+
+	Fill *findFill(uint32_t address)
+	{
+		for (Fill &fill : fills)
+			if (fill.line == address >> l2.lineBits)
+				return &fill;
+		return nullptr;
+	}
+
+	// run the DRAM controller up to the given cycle and time the fills it scheduled
+	void advance(int64_t now)
+	{
+		if (!useDram)
+			return;
+		scheduled.clear();
+		dram.advance(now, scheduled);
+		for (auto &s : scheduled)
+		{
+			findFill(s.first)->ready = s.second;
+			for (MissStatusRegisters::Entry &entry : mshrs.entries)
+				if (entry.ready == PENDING && (entry.line << l1d.lineBits) >> l2.lineBits == s.first >> l2.lineBits)
+					entry.ready = s.second;
+			int way = l1d.lookup(s.first);
+			if (way >= 0 && l1d.prefetched[way] == PENDING)
+				l1d.prefetched[way] = s.second;
+		}
+		fills.erase(std::remove_if(fills.begin(), fills.end(), [now](const Fill &fill)
+								   { return fill.ready < now; }),
+					fills.end());
+	}
+
+	// the ready cycle of an access to the byte address, PENDING until its DRAM fill is scheduled
+	int64_t resolve(uint32_t address, int64_t ready, int64_t now)
+	{
+		if (ready != PENDING)
+			return ready;
+		advance(now);
+		Fill *fill = findFill(address);
+		return fill ? fill->ready : now;
+	}
+
+	// ready cycle of an access reaching the second level after the given cycles above it
+	int64_t secondLevel(uint32_t address, int64_t now, int above)
+	{
+		bool hit = l2.access(address);
+		int64_t ready = now + above + l2.config.hitLatency;
+		if (Fill *fill = findFill(address))
+			return fill->ready == PENDING ? PENDING : std::max(fill->ready, ready);
+		if (hit)
+			return ready;
+		if (!useDram)
+			return ready + memoryLatency;
+		dram.request(address, ready);
+		fills.push_back({address >> l2.lineBits, PENDING});
+		return PENDING;
+	}
+
+	// ready cycle of an access through the given first level cache in the given cycle
+	int64_t access(Cache &l1, uint32_t address, int64_t now)
+	{
+		if (l1.access(address))
+			return now + l1.config.hitLatency - 1;
+		return secondLevel(address, now, l1.config.hitLatency - 1);
+	}
+
+	int64_t instruction(uint32_t address, int64_t now)
+	{
+		advance(now);
+		return access(l1i, address, now);
+	}
+
+	// fetch the line of the byte address into the first level data cache unless it is there or on its way
+	void prefetchLine(uint32_t address, int64_t now)
+	{
+		if (l1d.probe(address) || mshrs.find(address >> l1d.lineBits))
+			return;
+		++prefetch.issued;
+		l1d.prefetched[l1d.fill(address)] = secondLevel(address, now, 0);
+	}
+
+	// ready cycle of the data access of the lw/sw at pc in the given cycle, a prefetch still on its way is waited for
+	int64_t data(uint32_t address, int pc, int64_t now)
+	{
+		advance(now);
+		int way = l1d.lookup(address);
+		int64_t prefetched = way < 0 ? -1 : l1d.prefetched[way];
+		int64_t ready = access(l1d, address, now);
+		if (prefetched >= 0)
+		{
+			++prefetch.useful;
+			prefetch.timely += prefetched <= now;
+			l1d.prefetched[way] = -1;
+			ready = std::max(ready, prefetched);
+		}
+		else if (way < 0)
+			++prefetch.demandMisses;
+		if (prefetcher)
+		{
+			prefetches.clear();
+			prefetcher.access(pc, address, way >= 0, prefetches);
+			for (uint32_t target : prefetches)
+				prefetchLine(target, now);
+		}
+		return ready;
+	}
+
+	/*
+		non-blocking data access of the lw/sw at pc in the given cycle: the cycle in which its data
+		is ready, or -1 when it misses while all MSHRs are busy and has to be retried. A miss to a
+		line already being filled is ready with that fill.
+	*/
+	int64_t dataNonBlocking(uint32_t address, int pc, int64_t now)
+	{
+		advance(now);
+		uint32_t line = address >> l1d.lineBits;
+		if (MissStatusRegisters::Entry *entry = mshrs.find(line))
+		{
+			++mshrs.merges;
+			return entry->ready;
+		}
+		if (mshrs.full() && !l1d.probe(address))
+		{
+			++mshrs.fullStalls;
+			return -1;
+		}
+		bool hit = l1d.probe(address);
+		int64_t ready = data(address, pc, now);
+		if (!hit)
+		{
+			mshrs.entries.push_back({line, ready});
+			++mshrs.allocations;
+		}
+		return ready;
+	}
+
+	// retire the fills done by the given cycle
+	void tick(int64_t now)
+	{
+		advance(now);
+		mshrs.tick(now);
+	}
+
+	void report(std::ostream &out)
+	{
+		const std::pair<const char *, Cache *> levels[] = {{"L1I", &l1i}, {"L1D", &l1d}, {"L2", &l2}};
+		for (auto &level : levels)
+			out << level.first << ": " << level.second->hits << " hits, " << level.second->misses << " misses, hit rate "
+				<< std::fixed << std::setprecision(2) << 100 * level.second->hitRate() << "%\n"
+				<< std::defaultfloat;
+		if (mshrs.capacity > 0)
+			out << "MSHR: " << mshrs.allocations << " misses, " << mshrs.merges << " merged, " << mshrs.fullStalls
+				<< " cycles stalled on full MSHRs, memory level parallelism " << std::fixed << std::setprecision(2) << mshrs.parallelism()
+				<< " (peak " << mshrs.peak << ")\n"
+				<< std::defaultfloat;
+		if (prefetcher)
+			out << "Prefetch: " << prefetch.issued << " issued, " << prefetch.useful << " useful, accuracy " << std::fixed << std::setprecision(2)
+				<< 100 * prefetch.accuracy() << "%, coverage " << 100 * prefetch.coverage() << "%, timeliness " << 100 * prefetch.timeliness() << "%\n"
+				<< std::defaultfloat;
+		if (useDram)
+			out << "DRAM: " << dram.requests << " requests, " << dram.rowHits << " row hits, " << dram.rowMisses << " row misses, "
+				<< dram.rowConflicts << " row conflicts, average latency " << std::fixed << std::setprecision(2)
+				<< (dram.requests == 0 ? 0 : (double)dram.latency / dram.requests) << " cycles\n"
+				<< std::defaultfloat;
+	}
+
+	// whether the state of other fits this configuration, the configurations of the levels, the MSHRs and the memory behind them are part of the state
+	bool sameGeometry(const CacheHierarchy &other) const
+	{
+		return l1i.config == other.l1i.config && l1d.config == other.l1d.config && l2.config == other.l2.config && mshrs.capacity == other.mshrs.capacity && prefetcher.sameConfig(other.prefetcher) &&
+			   memoryLatency == other.memoryLatency && useDram == other.useDram && dram.config == other.dram.config &&
+			   l1i.tags.size() == other.l1i.tags.size() && l1d.tags.size() == other.l1d.tags.size() && l2.tags.size() == other.l2.tags.size() &&
+			   l1i.stamps.size() == l1i.tags.size() && l1d.stamps.size() == l1d.tags.size() && l2.stamps.size() == l2.tags.size() &&
+			   l1i.prefetched.size() == l1i.tags.size() && l1d.prefetched.size() == l1d.tags.size() && l2.prefetched.size() == l2.tags.size() &&
+			   dram.banks.size() == other.dram.banks.size() && dram.bus.size() == other.dram.bus.size() && dram.queues.size() == other.dram.queues.size();
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		l1i.transfer(a), l1d.transfer(a), l2.transfer(a);
+		mshrs.transfer(a);
+		a.field(prefetch);
+		prefetcher.transfer(a);
+		a.field(memoryLatency), a.field(useDram);
+		dram.transfer(a);
+		a.field(fills);
+	}
+};
+
+#endif
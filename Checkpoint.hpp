@@ -0,0 +1,179 @@
+/**
+ * @file Checkpoint.hpp
+ * streamed on-disk checkpoints of the pipelined simulators
+ */
+
+#ifndef __CHECKPOINT_HPP__
+#define __CHECKPOINT_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <unistd.h>
+#include "Memory.hpp"
+
+/*
+	a checkpoint file is a header followed by the fields of the state in the order the simulator
+	lists them in its transfer function: plain values are stored as they are in memory, containers
+	as their size followed by their elements and the data memory as its page count followed by the
+	number and the words of every allocated page. Values are in the byte order of the host.
+*/
+struct CheckpointHeader
+{
+	char magic[8];
+	uint32_t version, variant;
+};
+
+static const char CHECKPOINT_MAGIC[8] = {'M', 'I', 'P', 'S', 'C', 'K', 'P', 'T'};
+static const uint32_t CHECKPOINT_VERSION = 18;
+
+// writes the fields of a checkpoint to a temporary file which replaces the checkpoint file on commit
+struct CheckpointWriter
+{
+	std::string fileName, tempName;
+	std::ofstream out;
+	char buffer[1 << 16];
+
+	CheckpointWriter(const std::string &fileName, uint32_t variant) : fileName(fileName), tempName(fileName + ".tmp" + std::to_string(getpid()))
+	{
+		out.rdbuf()->pubsetbuf(buffer, sizeof(buffer));
+		out.open(tempName, std::ios::binary | std::ios::trunc);
+		CheckpointHeader header;
+		memcpy(header.magic, CHECKPOINT_MAGIC, 8);
+		header.version = CHECKPOINT_VERSION;
+		header.variant = variant;
+		field(header);
+	}
+
+	template <typename T>
+	void field(T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values are stored directly");
+		out.write((const char *)&value, sizeof(T));
+	}
+
+	template <typename T>
+	void field(std::vector<T> &values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only vectors of plain values are stored");
+		uint32_t size = values.size();
+		field(size);
+		out.write((const char *)values.data(), size * sizeof(T));
+	}
+
+	void field(std::map<int, int> &values)
+	{
+		uint32_t size = values.size();
+		field(size);
+		for (auto &entry : values)
+		{
+			int key = entry.first;
+			field(key);
+			field(entry.second);
+		}
+	}
+
+	void field(PagedMemory &memory)
+	{
+		const std::vector<uint32_t> &pages = memory.allocatedPages();
+		uint32_t size = pages.size();
+		field(size);
+		for (uint32_t p : pages)
+		{
+			field(p);
+			out.write((const char *)memory.page(p * PagedMemory::PAGE_WORDS), PagedMemory::PAGE_WORDS * sizeof(int));
+		}
+	}
+
+	// finish the file and move it over the checkpoint file, false if anything failed
+	bool commit()
+	{
+		out.close();
+		if (!out || rename(tempName.c_str(), fileName.c_str()))
+		{
+			remove(tempName.c_str());
+			return false;
+		}
+		return true;
+	}
+};
+
+// reads the fields of a checkpoint, ok turns false on a bad header or a truncated file and nothing is read after that
+struct CheckpointReader
+{
+	std::ifstream in;
+	char buffer[1 << 16];
+	bool ok = true;
+
+	CheckpointReader(const std::string &fileName, uint32_t variant)
+	{
+		in.rdbuf()->pubsetbuf(buffer, sizeof(buffer));
+		in.open(fileName, std::ios::binary);
+		CheckpointHeader header;
+		field(header);
+		ok = ok && !memcmp(header.magic, CHECKPOINT_MAGIC, 8) && header.version == CHECKPOINT_VERSION && header.variant == variant;
+	}
+
+	template <typename T>
+	void field(T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values are stored directly");
+		ok = ok && bool(in.read((char *)&value, sizeof(T)));
+	}
+
+	// element counts are checked against the remaining file before anything is allocated for them
+	bool count(uint32_t &size, size_t elementBytes)
+	{
+		if (!ok)
+			return false;
+		field(size);
+		if (!ok)
+			return false;
+		std::streampos here = in.tellg();
+		in.seekg(0, std::ios::end);
+		std::streamoff left = in.tellg() - here;
+		in.seekg(here);
+		return ok = (uint64_t)size * elementBytes <= (uint64_t)left;
+	}
+
+	template <typename T>
+	void field(std::vector<T> &values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only vectors of plain values are stored");
+		uint32_t size;
+		if (!count(size, sizeof(T)))
+			return;
+		values.resize(size);
+		ok = ok && bool(in.read((char *)values.data(), (size_t)size * sizeof(T)));
+	}
+
+	void field(std::map<int, int> &values)
+	{
+		uint32_t size;
+		if (!count(size, 2 * sizeof(int)))
+			return;
+		values.clear();
+		for (int key; size-- && ok;)
+			field(key), field(values[key]);
+	}
+
+	void field(PagedMemory &memory)
+	{
+		uint32_t size;
+		if (!count(size, sizeof(uint32_t) + PagedMemory::PAGE_WORDS * sizeof(int)))
+			return;
+		memory.clear();
+		for (uint32_t p; size-- && ok;)
+		{
+			field(p);
+			ok = ok && in.read((char *)memory.touch(p * PagedMemory::PAGE_WORDS), PagedMemory::PAGE_WORDS * sizeof(int));
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file Dram.hpp
+ * DRAM controller timing model behind the cache hierarchy
+ */
+
+#ifndef __DRAM_HPP__
+#define __DRAM_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// sizes in bytes, latencies in cycles from the start of an access until its data is on the bus
+struct DramConfig
+{
+	int channels = 1, banks = 8, rowSize = 2048;
+	// an open page policy keeps the row of the last access open, a closed page policy precharges after every access
+	bool openPage = true;
+	// access to the open row, to a precharged bank and to a bank with another row open
+	int rowHit = 15, rowMiss = 30, rowConflict = 45;
+	// cycles the data bus of a channel is busy transferring a line
+	int burst = 4;
+
+	bool operator==(const DramConfig &other) const
+	{
+		return channels == other.channels && banks == other.banks && rowSize == other.rowSize && openPage == other.openPage &&
+			   rowHit == other.rowHit && rowMiss == other.rowMiss && rowConflict == other.rowConflict && burst == other.burst;
+	}
+};
+
+/*
+	line requests queue per channel and are scheduled first ready, first come first served: each
+	cycle every channel starts the oldest request to an idle bank which hits its open row, or the
+	oldest request to an idle bank if none does. Consecutive lines share a row; the rows are
+	interleaved across the channels and then the banks.
+*/
+struct DramController
+{
+	struct Bank
+	{
+		int64_t row = -1, busy = 0;
+	};
+	struct Request
+	{
+		uint32_t address;
+		int64_t arrival;
+	};
+
+	DramConfig config;
+	std::vector<Bank> banks;
+	std::vector<int64_t> bus;
+	std::vector<std::vector<Request>> queues;
+	int64_t now = -1;
+	uint64_t requests = 0, rowHits = 0, rowMisses = 0, rowConflicts = 0, latency = 0;
+
+	DramController(const DramConfig &config = DramConfig())
+		: config(config), banks(config.channels * config.banks), bus(config.channels, 0), queues(config.channels) {}
+
+	int channel(uint32_t address) const
+	{
+		return address / config.rowSize % config.channels;
+	}
+
+	int bank(uint32_t address) const
+	{
+		return address / config.rowSize / config.channels % config.banks;
+	}
+
+	int64_t row(uint32_t address) const
+	{
+		return address / config.rowSize / config.channels / config.banks;
+	}
+
+	// queue the line of the byte address arriving in the given cycle
+	void request(uint32_t address, int64_t arrival)
+	{
+		queues[channel(address)].push_back({address, arrival});
+		++requests;
+	}
+
+	// schedule the cycles up to the given one, appending (address, cycle its line is transferred) for every request started
+	void advance(int64_t to, std::vector<std::pair<uint32_t, int64_t>> &done)
+	{
+		for (int c = 0; c < config.channels; ++c)
+		{
+			std::vector<Request> &queue = queues[c];
+			for (int64_t cycle = now + 1; cycle <= to && !queue.empty(); ++cycle)
+			{
+				int pick = -1;
+				bool hit = false;
+				for (int i = 0; i < (int)queue.size() && !hit; ++i)
+				{
+					const Bank &b = banks[c * config.banks + bank(queue[i].address)];
+					if (queue[i].arrival > cycle || b.busy > cycle)
+						continue;
+					hit = config.openPage && b.row == row(queue[i].address);
+					if (pick < 0 || hit)
+						pick = i;
+				}
+				if (pick < 0)
+				{
+					// nothing can start before the next bank is idle or request arrives
+					int64_t next = INT64_MAX;
+					for (const Request &r : queue)
+						next = std::min(next, std::max(r.arrival, banks[c * config.banks + bank(r.address)].busy));
+					cycle = std::max(cycle, std::min(next, to + 1) - 1);
+					continue;
+				}
+				Request r = queue[pick];
+				queue.erase(queue.begin() + pick);
+				Bank &b = banks[c * config.banks + bank(r.address)];
+				int access;
+				if (b.row == row(r.address))
+					access = config.rowHit, ++rowHits;
+				else if (b.row < 0)
+					access = config.rowMiss, ++rowMisses;
+				else
+					access = config.rowConflict, ++rowConflicts;
+				int64_t transferred = std::max(cycle + access, bus[c]) + config.burst;
+				bus[c] = transferred;
+				b.busy = config.openPage ? cycle + access : transferred;
+				b.row = config.openPage ? row(r.address) : -1;
+				latency += transferred - r.arrival;
+				done.push_back({r.address, transferred});
+			}
+		}
+		now = std::max(now, to);
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(config);
+		a.field(banks);
+		a.field(bus);
+		for (auto &queue : queues)
+			a.field(queue);
+		a.field(now);
+		a.field(requests), a.field(rowHits), a.field(rowMisses), a.field(rowConflicts), a.field(latency);
+	}
+};
+
+#endif
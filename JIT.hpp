@@ -0,0 +1,131 @@
+/**
+ * @file JIT.hpp
+ * x86-64 code emission and executable memory used by the basic block JIT of MIPS_Architecture
+ */
+
+#ifndef __JIT_HPP__
+#define __JIT_HPP__
+
+#if defined(__x86_64__) && defined(__unix__)
+#define MIPS_JIT_SUPPORTED 1
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+
+// the few x86-64 instructions needed to translate the MIPS commands, operands are eax/ecx/r8 and
+// 32 bit displacements from the register file (rdi), the page directory of the data memory (rsi) or counters (rdx)
+struct X86Emitter
+{
+	std::vector<uint8_t> code;
+
+	void byte(uint8_t b) { code.push_back(b); }
+	void bytes(std::initializer_list<uint8_t> bs) { code.insert(code.end(), bs); }
+	void imm32(int32_t v)
+	{
+		for (int i = 0; i < 4; ++i)
+			byte((v >> (8 * i)) & 0xff);
+	}
+
+	// ModRM for [rdi + disp32] with the given register field
+	void rdiDisp(int reg, int disp) { byte(0x87 | reg << 3), imm32(disp); }
+
+	void movEaxReg(int r) { byte(0x8B), rdiDisp(0, 4 * r); }	// mov eax, [rdi + 4r]
+	void movEcxReg(int r) { byte(0x8B), rdiDisp(1, 4 * r); }	// mov ecx, [rdi + 4r]
+	void movRegEax(int r) { byte(0x89), rdiDisp(0, 4 * r); }	// mov [rdi + 4r], eax
+	void movRegEcx(int r) { byte(0x89), rdiDisp(1, 4 * r); }	// mov [rdi + 4r], ecx
+	void addEaxReg(int r) { byte(0x03), rdiDisp(0, 4 * r); }	// add eax, [rdi + 4r]
+	void subEaxReg(int r) { byte(0x2B), rdiDisp(0, 4 * r); }	// sub eax, [rdi + 4r]
+	void imulEaxReg(int r) { bytes({0x0F, 0xAF}), rdiDisp(0, 4 * r); } // imul eax, [rdi + 4r]
+	void cmpEaxReg(int r) { byte(0x3B), rdiDisp(0, 4 * r); }	// cmp eax, [rdi + 4r]
+	void addEaxImm(int v) { byte(0x05), imm32(v); }				// add eax, imm32
+	void cmpEaxImm(int v) { byte(0x3D), imm32(v); }				// cmp eax, imm32
+	void movEaxImm(int v) { byte(0xB8), imm32(v); }				// mov eax, imm32
+	void movEcxImm(int v) { byte(0xB9), imm32(v); }				// mov ecx, imm32
+	void setlEax() { bytes({0x0F, 0x9C, 0xC0, 0x0F, 0xB6, 0xC0}); } // setl al; movzx eax, al
+	void cmoveEaxEcx() { bytes({0x0F, 0x44, 0xC1}); }			// cmove eax, ecx
+	void cmovneEaxEcx() { bytes({0x0F, 0x45, 0xC1}); }			// cmovne eax, ecx
+	void testAlImm(uint8_t v) { bytes({0xA8, v}); }				// test al, imm8
+	void movEcxEax() { bytes({0x89, 0xC1}); }					// mov ecx, eax
+	void shrEcx(uint8_t v) { bytes({0xC1, 0xE9, v}); }			// shr ecx, imm8
+	void andEcxImm(int v) { bytes({0x81, 0xE1}), imm32(v); }	// and ecx, imm32
+	void andEaxImm(int v) { byte(0x25), imm32(v); }				// and eax, imm32
+	void xorEcxEcx() { bytes({0x31, 0xC9}); }					// xor ecx, ecx
+	void loadTable() { bytes({0x4C, 0x8B, 0x04, 0xCE}); }		// mov r8, [rsi + 8rcx]
+	void loadPage() { bytes({0x4D, 0x8B, 0x04, 0xC8}); }		// mov r8, [r8 + 8rcx]
+	void testR8() { bytes({0x4D, 0x85, 0xC0}); }				// test r8, r8
+	void cmpR8Imm(int disp, int8_t v) { bytes({0x41, 0x83, 0xB8}), imm32(disp), byte(v); } // cmp dword [r8 + disp], imm8
+	void loadWord() { bytes({0x41, 0x8B, 0x0C, 0x00}); }		// mov ecx, [r8 + rax]
+	void storeWord() { bytes({0x41, 0x89, 0x0C, 0x00}); }		// mov [r8 + rax], ecx
+	void incCounter(int i) { bytes({0x83, 0x82}), imm32(4 * i), byte(1); } // add dword [rdx + 4i], 1
+	void ret() { byte(0xC3); }
+
+	// conditional jump with a 32 bit displacement, returns the position to patch
+	size_t jcc(uint8_t cc)
+	{
+		bytes({0x0F, cc});
+		imm32(0);
+		return code.size();
+	}
+	// unconditional jump with a 32 bit displacement, returns the position to patch
+	size_t jmp()
+	{
+		byte(0xE9);
+		imm32(0);
+		return code.size();
+	}
+	// point the jump ending at the given position to the current position
+	void patch(size_t end)
+	{
+		int32_t rel = code.size() - end;
+		memcpy(&code[end - 4], &rel, 4);
+	}
+
+	static constexpr uint8_t JB = 0x82, JAE = 0x83, JZ = 0x84, JNE = 0x85;
+};
+
+// executable memory for the translated blocks, filled in chunks which are only writable while being appended to
+struct ExecutableMemory
+{
+	static constexpr size_t CHUNK = 1 << 16;
+	std::vector<std::pair<uint8_t *, size_t>> chunks;
+	size_t used = CHUNK;
+
+	ExecutableMemory() = default;
+	ExecutableMemory(const ExecutableMemory &) = delete;
+	ExecutableMemory &operator=(const ExecutableMemory &) = delete;
+
+	// copy the code into executable memory and return its address, nullptr if that fails
+	void *install(const std::vector<uint8_t> &code)
+	{
+		if (code.size() > CHUNK)
+			return nullptr;
+		if (used + code.size() > CHUNK)
+		{
+			void *chunk = mmap(nullptr, CHUNK, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (chunk == MAP_FAILED)
+				return nullptr;
+			chunks.push_back({(uint8_t *)chunk, CHUNK});
+			used = 0;
+		}
+		uint8_t *chunk = chunks.back().first;
+		if (mprotect(chunk, CHUNK, PROT_READ | PROT_WRITE))
+			return nullptr;
+		memcpy(chunk + used, code.data(), code.size());
+		mprotect(chunk, CHUNK, PROT_READ | PROT_EXEC);
+		void *entry = chunk + used;
+		used += code.size();
+		return entry;
+	}
+
+	~ExecutableMemory()
+	{
+		for (auto &chunk : chunks)
+			munmap(chunk.first, chunk.second);
+	}
+};
+
+#endif
+
+#endif
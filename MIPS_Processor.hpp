@@ -9,22 +9,173 @@
 
 #include <unordered_map>
 #include <string>
-#include <functional>
 #include <vector>
 #include <fstream>
 #include <exception>
 #include <iostream>
-#include <boost/tokenizer.hpp>
 #include<queue>
+#include <array>
+#include <deque>
+#include <string_view>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "JIT.hpp"
+#include "Memory.hpp"
+#include "PerfectHash.hpp"
+
+// program text the parsed commands point into, either a memory mapped file or an owned copy
+struct SourceBuffer
+{
+	std::string text;
+	const char *mapped = nullptr;
+	size_t mappedSize = 0;
+	// command text that is not found contiguously in the source (joined operands, image strings)
+	std::deque<std::string> owned;
+
+	SourceBuffer() = default;
+	SourceBuffer(const SourceBuffer &) = delete;
+	SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+	// memory map the file, fails if it cannot be opened or is empty
+	bool map(const std::string &fileName)
+	{
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat st;
+		void *file = MAP_FAILED;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+			file = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (file == MAP_FAILED)
+			return false;
+		mapped = (const char *)file, mappedSize = st.st_size;
+		return true;
+	}
+
+	// drop the source text, only the owned text is kept
+	void unmap()
+	{
+		if (mapped != nullptr)
+			munmap((void *)mapped, mappedSize);
+		mapped = nullptr, mappedSize = 0;
+		text.clear();
+	}
+
+	std::string_view view() const
+	{
+		return mapped != nullptr ? std::string_view(mapped, mappedSize) : std::string_view(text);
+	}
+
+	~SourceBuffer()
+	{
+		unmap();
+	}
+};
+
+// commands and labels parsed from a line aligned part of the program text
+struct ParsedChunk
+{
+	std::vector<std::array<std::string_view, 4>> commands;
+	// labels in order of definition, with the index of the command they label
+	std::vector<std::pair<std::string_view, int>> labels;
+	// commands with more than 4 tokens, with their fourth operand joined with the rest
+	std::vector<std::pair<int, std::string>> joined;
+
+	// parse the command assuming correctly formatted MIPS instruction (or label), the tokens view the line
+	void parseCommand(std::string_view line, std::vector<std::string_view> &command)
+	{
+		// strip until before the comment begins
+		line = line.substr(0, line.find('#'));
+		command.clear();
+		auto separator = [](char c)
+		{ return c == ',' || c == ' ' || c == '\t'; };
+		for (size_t i = 0, j; i < line.size(); i = j)
+		{
+			while (i < line.size() && separator(line[i]))
+				++i;
+			for (j = i; j < line.size() && !separator(line[j]); ++j)
+				;
+			if (j > i)
+				command.push_back(line.substr(i, j - i));
+		}
+		// empty line or a comment only line
+		if (command.empty())
+			return;
+		else if (command.size() == 1)
+		{
+			labels.emplace_back(command[0].back() == ':' ? command[0].substr(0, command[0].size() - 1) : "?", commands.size());
+			command.clear();
+		}
+		else if (command[0].back() == ':')
+		{
+			labels.emplace_back(command[0].substr(0, command[0].size() - 1), commands.size());
+			command.erase(command.begin());
+		}
+		else if (command[0].find(':') != std::string_view::npos)
+		{
+			int idx = command[0].find(':');
+			labels.emplace_back(command[0].substr(0, idx), commands.size());
+			command[0] = command[0].substr(idx + 1);
+		}
+		else if (command[1][0] == ':')
+		{
+			labels.emplace_back(command[0], commands.size());
+			command[1] = command[1].substr(1);
+			if (command[1].empty())
+				command.erase(command.begin(), command.begin() + 2);
+			else
+				command.erase(command.begin(), command.begin() + 1);
+		}
+		if (command.empty())
+			return;
+		if (command.size() > 4)
+		{
+			std::string operand(command[3]);
+			for (int i = 4; i < (int)command.size(); ++i)
+				operand += ' ', operand += command[i];
+			joined.emplace_back(commands.size(), operand);
+		}
+		command.resize(4);
+		commands.push_back({command[0], command[1], command[2], command[3]});
+	}
+
+	// parse the text line by line
+	void parse(std::string_view text)
+	{
+		std::vector<std::string_view> command;
+		commands.reserve(std::count(text.begin(), text.end(), '\n') + 1);
+		while (!text.empty())
+		{
+			size_t end = text.find('\n');
+			parseCommand(text.substr(0, end), command);
+			if (end == std::string_view::npos)
+				break;
+			text.remove_prefix(end + 1);
+		}
+	}
+};
 
 struct MIPS_Architecture
 {
 	int registers[32] = {0}, PCcurr = 0, PCnext;
-	std::unordered_map<std::string, std::function<int(MIPS_Architecture &, std::string, std::string, std::string)>> instructions;
-	std::unordered_map<std::string, int> registerMap, address;
+	std::unordered_map<std::string, int> address;
 	static const int MAX = (1 << 20);
-	int data[MAX >> 2] = {0};
-	std::vector<std::vector<std::string>> commands;
+	// bytes of data memory that can be addressed, anything up to the whole 32 bit address space
+	uint64_t memoryLimit = MAX;
+	PagedMemory data;
+	// the 4 tokens of every command, viewing the program text held by source
+	std::vector<std::array<std::string_view, 4>> commands;
+	SourceBuffer source;
+	// threads used to parse and decode large programs, 0 uses all hardware threads
+	static inline int loaderThreads = 0;
+	// smallest amount of program text or commands handed to a loader thread
+	static const size_t PARALLEL_BYTES = 1 << 22, PARALLEL_COMMANDS = 1 << 17;
 	std::vector<int> commandCount;
 	enum exit_code
 	{
@@ -36,154 +187,381 @@ struct MIPS_Architecture
 		MEMORY_ERROR
 	};
 
-	// constructor to initialise the instruction set
-	MIPS_Architecture(std::ifstream &file)
+	// opcodes of the pre-decoded commands, OP_ERROR carries the exit code of a command that fails
+	enum opcode : uint8_t
 	{
-		instructions = {{"add", &MIPS_Architecture::add}, {"sub", &MIPS_Architecture::sub}, {"mul", &MIPS_Architecture::mul}, {"beq", &MIPS_Architecture::beq}, {"bne", &MIPS_Architecture::bne}, {"slt", &MIPS_Architecture::slt}, {"j", &MIPS_Architecture::j}, {"lw", &MIPS_Architecture::lw}, {"sw", &MIPS_Architecture::sw}, {"addi", &MIPS_Architecture::addi}};
+		OP_ADD = 0,
+		OP_SUB,
+		OP_MUL,
+		OP_SLT,
+		OP_ADDI,
+		OP_BEQ,
+		OP_BNE,
+		OP_J,
+		OP_LW,
+		OP_SW,
+		OP_ERROR
+	};
 
-		for (int i = 0; i < 32; ++i)
-			registerMap["$" + std::to_string(i)] = i;
-		registerMap["$zero"] = 0;
-		registerMap["$at"] = 1;
-		registerMap["$v0"] = 2;
-		registerMap["$v1"] = 3;
-		for (int i = 0; i < 4; ++i)
-			registerMap["$a" + std::to_string(i)] = i + 4;
-		for (int i = 0; i < 8; ++i)
-			registerMap["$t" + std::to_string(i)] = i + 8, registerMap["$s" + std::to_string(i)] = i + 16;
-		registerMap["$t8"] = 24;
-		registerMap["$t9"] = 25;
-		registerMap["$k0"] = 26;
-		registerMap["$k1"] = 27;
-		registerMap["$gp"] = 28;
-		registerMap["$sp"] = 29;
-		registerMap["$s8"] = 30;
-		registerMap["$ra"] = 31;
+	/*
+		compact fixed-size form of a command, resolved once at load time:
+		rd: destination register (data register for lw/sw)
+		rs, rt: source registers (base register for lw/sw)
+		imm: immediate, memory offset, branch target index or exit code for OP_ERROR
+	*/
+	struct DecodedCommand
+	{
+		uint8_t op, rd, rs, rt;
+		int imm;
+	};
+	std::vector<DecodedCommand> decoded;
+
+	// opcode of every instruction name, built at compile time
+	static constexpr PerfectHash<10, 32> instructions = PerfectHash<10, 32>({{"add", OP_ADD}, {"sub", OP_SUB}, {"mul", OP_MUL}, {"slt", OP_SLT}, {"addi", OP_ADDI}, {"beq", OP_BEQ}, {"bne", OP_BNE}, {"j", OP_J}, {"lw", OP_LW}, {"sw", OP_SW}});
+	// index of every register name, numeric and conventional, built at compile time
+	static constexpr PerfectHash<64, 512> registerMap = PerfectHash<64, 512>({
+		{"$0", 0}, {"$1", 1}, {"$2", 2}, {"$3", 3}, {"$4", 4}, {"$5", 5}, {"$6", 6}, {"$7", 7},
+		{"$8", 8}, {"$9", 9}, {"$10", 10}, {"$11", 11}, {"$12", 12}, {"$13", 13}, {"$14", 14}, {"$15", 15},
+		{"$16", 16}, {"$17", 17}, {"$18", 18}, {"$19", 19}, {"$20", 20}, {"$21", 21}, {"$22", 22}, {"$23", 23},
+		{"$24", 24}, {"$25", 25}, {"$26", 26}, {"$27", 27}, {"$28", 28}, {"$29", 29}, {"$30", 30}, {"$31", 31},
+		{"$zero", 0}, {"$at", 1}, {"$v0", 2}, {"$v1", 3}, {"$a0", 4}, {"$a1", 5}, {"$a2", 6}, {"$a3", 7},
+		{"$t0", 8}, {"$t1", 9}, {"$t2", 10}, {"$t3", 11}, {"$t4", 12}, {"$t5", 13}, {"$t6", 14}, {"$t7", 15},
+		{"$s0", 16}, {"$s1", 17}, {"$s2", 18}, {"$s3", 19}, {"$s4", 20}, {"$s5", 21}, {"$s6", 22}, {"$s7", 23},
+		{"$t8", 24}, {"$t9", 25}, {"$k0", 26}, {"$k1", 27}, {"$gp", 28}, {"$sp", 29}, {"$s8", 30}, {"$ra", 31}});
+	// print the registers after every cycle, disabled for benchmarking
+	bool printCycles = true;
+
+	// superinstructions: sequences of decoded commands run by a single handler of the threaded engine
+	enum fusion_kind : uint8_t
+	{
+		FUSE_NONE = 0,
+		FUSE_ADDI_SLT_BNE,
+		FUSE_ADDI_LW
+	};
+	// fusion kind of the sequence starting at every command
+	std::vector<uint8_t> fused;
+	// run the fused sequences with their superinstruction handler
+	bool useFusion = true;
+
+	// executions of a command after which the basic block starting at it is translated by the JIT
+	int jitThreshold = 50;
+#ifdef MIPS_JIT_SUPPORTED
+	// translated basic block, returns the next PC or -(PC + 1) of a lw/sw left to the interpreter
+	typedef int (*CompiledBlock)(int *registers, PagedMemory::Table **tables, int *commandCount);
+	std::vector<CompiledBlock> blocks;
+	// number of commands in the block starting at every command, -1 if it could not be translated
+	std::vector<int> blockLength;
+	ExecutableMemory jitMemory;
+#endif
 
+	// constructor reading the program from the input file
+	MIPS_Architecture(std::ifstream &file)
+	{
 		constructCommands(file);
+		decodeCommands();
+		fuseCommands();
 		commandCount.assign(commands.size(), 0);
 	}
 
-	// perform add operation
-	int add(std::string r1, std::string r2, std::string r3)
+	/*
+		constructor memory mapping the program file, optionally loading it through a compiled image:
+		the image is used if it was built from the same source contents, otherwise the source is
+		parsed and the image (re)written
+	*/
+	MIPS_Architecture(const std::string &fileName, const std::string &imageName = "")
 	{
-		return op(r1, r2, r3, [&](int a, int b)
-				  { return a + b; });
+		if (!source.map(fileName))
+		{
+			std::ifstream file(fileName);
+			source.text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+		uint64_t hash = imageName.empty() ? 0 : hashSource(source.view());
+		if (imageName.empty() || !loadImage(imageName, hash))
+		{
+			parseSource();
+			decodeCommands();
+			if (!imageName.empty())
+				saveImage(imageName, hash);
+		}
+		fuseCommands();
+		commandCount.assign(commands.size(), 0);
 	}
 
-	// perform subtraction operation
-	int sub(std::string r1, std::string r2, std::string r3)
+	// checks if the byte address is word aligned, past the commands and within the memory limit
+	inline bool validAddress(uint32_t address)
 	{
-		return op(r1, r2, r3, [&](int a, int b)
-				  { return a - b; });
+		return address % 4 == 0 && address >= 4 * commands.size() && address < memoryLimit;
 	}
 
-	// perform multiplication operation
-	int mul(std::string r1, std::string r2, std::string r3)
+	// checks if label is valid
+	inline bool checkLabel(std::string_view str)
 	{
-		return op(r1, r2, r3, [&](int a, int b)
-				  { return a * b; });
+		return str.size() > 0 && isalpha(str[0]) && std::all_of(str.begin() + 1, str.end(), [](char c)
+														   { return (bool)isalnum(c); }) &&
+			   !instructions.contains(str);
 	}
 
-	// perform the binary operation
-	int op(std::string r1, std::string r2, std::string r3, std::function<int(int, int)> operation)
+	/*
+		handle all exit codes:
+		0: correct execution
+		1: register provided is incorrect
+		2: invalid label
+		3: unaligned or invalid address
+		4: syntax error
+		5: commands exceed memory limit
+	*/
+	void handleExit(exit_code code, int cycleCount)
 	{
-		if (!checkRegisters({r1, r2, r3}) || registerMap[r1] == 0)
-			return 1;
-		registers[registerMap[r1]] = operation(registers[registerMap[r2]], registers[registerMap[r3]]);
-		PCnext = PCcurr + 1;
-		return 0;
+		std::cout << '\n';
+		switch (code)
+		{
+		case 1:
+			std::cerr << "Invalid register provided or syntax error in providing register\n";
+			break;
+		case 2:
+			std::cerr << "Label used not defined or defined too many times\n";
+			break;
+		case 3:
+			std::cerr << "Unaligned or invalid memory address specified\n";
+			break;
+		case 4:
+			std::cerr << "Syntax error encountered\n";
+			break;
+		case 5:
+			std::cerr << "Memory limit exceeded\n";
+			break;
+		default:
+			break;
+		}
+		if (code != 0)
+		{
+			std::cerr << "Error encountered at:\n";
+			for (auto &s : commands[PCcurr])
+				std::cerr << s << ' ';
+			std::cerr << '\n';
+		}
+		std::cout << "\nFollowing are the non-zero data values:\n";
+		data.forEachNonZero([](uint32_t i, int value)
+							{ std::cout << 4ULL * i << '-' << 4ULL * i + 3 << std::hex << ": " << value << '\n'
+										<< std::dec; });
+		std::cout << "\nTotal number of cycles: " << cycleCount << '\n';
+		std::cout << "Count of instructions executed:\n";
+		for (int i = 0; i < (int)commands.size(); ++i)
+		{
+			std::cout << commandCount[i] << " times:\t";
+			for (auto &s : commands[i])
+				std::cout << s << ' ';
+			std::cout << '\n';
+		}
 	}
 
-	// perform the beq operation
-	int beq(std::string r1, std::string r2, std::string label)
+	// define a label at the given command, a label defined more than once is invalid (-1)
+	void defineLabel(std::string_view label, int index)
 	{
-		return bOP(r1, r2, label, [](int a, int b)
-				   { return a == b; });
+		auto it = address.try_emplace(std::string(label), index);
+		if (!it.second)
+			it.first->second = -1;
 	}
 
-	// perform the bne operation
-	int bne(std::string r1, std::string r2, std::string label)
+	// append a parsed chunk to the program, its labels are defined in order as if the lines were parsed here
+	void mergeChunk(ParsedChunk &chunk)
 	{
-		return bOP(r1, r2, label, [](int a, int b)
-				   { return a != b; });
+		int offset = commands.size();
+		for (auto &label : chunk.labels)
+			defineLabel(label.first, offset + label.second);
+		if (commands.empty())
+			commands = std::move(chunk.commands);
+		else
+			commands.insert(commands.end(), chunk.commands.begin(), chunk.commands.end());
+		for (auto &joined : chunk.joined)
+		{
+			source.owned.push_back(std::move(joined.second));
+			commands[offset + joined.first][3] = source.owned.back();
+		}
 	}
 
-	// implements beq and bne by taking the comparator
-	int bOP(std::string r1, std::string r2, std::string label, std::function<bool(int, int)> comp)
+	// number of threads for work over the given number of bytes or commands
+	static int workerThreads(size_t work, size_t minimum)
 	{
-		if (!checkLabel(label))
-			return 4;
-		if (address.find(label) == address.end() || address[label] == -1)
-			return 2;
-		if (!checkRegisters({r1, r2}))
-			return 1;
-		PCnext = comp(registers[registerMap[r1]], registers[registerMap[r2]]) ? address[label] : PCcurr + 1;
-		return 0;
+		int threads = loaderThreads > 0 ? loaderThreads : std::max(1u, std::thread::hardware_concurrency());
+		return std::max<size_t>(1, std::min<size_t>(threads, work / minimum));
 	}
 
-	// implements slt operation
-	int slt(std::string r1, std::string r2, std::string r3)
+	/*
+		parse the program text in a single pass: large programs are split into line aligned chunks
+		which are parsed on separate threads and merged in order
+	*/
+	void parseSource()
 	{
-		if (!checkRegisters({r1, r2, r3}) || registerMap[r1] == 0)
-			return 1;
-		registers[registerMap[r1]] = registers[registerMap[r2]] < registers[registerMap[r3]];
-		PCnext = PCcurr + 1;
-		return 0;
+		std::string_view text = source.view();
+		int threads = workerThreads(text.size(), PARALLEL_BYTES);
+		std::vector<std::string_view> parts;
+		for (int i = threads; i > 0; --i)
+		{
+			size_t end = i == 1 ? text.size() : text.find('\n', text.size() / i);
+			end = end == std::string_view::npos ? text.size() : end + 1;
+			parts.push_back(text.substr(0, end));
+			text.remove_prefix(end);
+		}
+
+		std::vector<ParsedChunk> chunks(parts.size());
+		std::vector<std::thread> workers;
+		for (int i = 1; i < (int)parts.size(); ++i)
+			workers.emplace_back([&chunks, &parts, i]()
+								 { chunks[i].parse(parts[i]); });
+		chunks[0].parse(parts[0]);
+		for (auto &worker : workers)
+			worker.join();
+
+		size_t total = commands.size();
+		for (auto &chunk : chunks)
+			total += chunk.commands.size();
+		commands.reserve(total);
+		for (auto &chunk : chunks)
+			mergeChunk(chunk);
+	}
+
+	// construct the commands vector from the input file
+	void constructCommands(std::ifstream &file)
+	{
+		source.text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		file.close();
+		parseSource();
 	}
 
-	// perform the jump operation
-	int j(std::string label, std::string unused1 = "", std::string unused2 = "")
+	/*
+		compiled program image, laid out as:
+		ImageHeader | DecodedCommand[commands] | int label index[labels] | strings
+		where strings holds the 4 tokens of every command followed by the label names, each null terminated
+	*/
+	struct ImageHeader
+	{
+		char magic[8];
+		uint32_t version, commands, labels, stringBytes;
+		uint64_t sourceHash;
+	};
+	static const uint32_t IMAGE_VERSION = 1;
+
+	// 64 bit FNV-1a hash of the program source, identifies the source an image was built from
+	static uint64_t hashSource(std::string_view source)
 	{
-		if (!checkLabel(label))
-			return 4;
-		if (address.find(label) == address.end() || address[label] == -1)
-			return 2;
-		PCnext = address[label];
-		return 0;
+		uint64_t hash = 14695981039346656037ULL;
+		for (unsigned char c : source)
+			hash = (hash ^ c) * 1099511628211ULL;
+		return hash;
 	}
 
-	// perform load word operation
-	int lw(std::string r, std::string location, std::string unused1 = "")
+	// write the image of the parsed and decoded program, written to a temporary file and renamed so readers never see a partial image
+	bool saveImage(const std::string &imageName, uint64_t hash)
 	{
-		if (!checkRegister(r) || registerMap[r] == 0)
-			return 1;
-		int address = locateAddress(location);
-		if (address < 0)
-			return abs(address);
-		registers[registerMap[r]] = data[address];
-		PCnext = PCcurr + 1;
-		return 0;
+		std::string strings;
+		std::vector<int> labelIndex;
+		for (auto &command : commands)
+			for (auto &s : command)
+				strings += s, strings += '\0';
+		for (auto &label : address)
+			strings += label.first, strings += '\0', labelIndex.push_back(label.second);
+
+		ImageHeader header = {{'M', 'I', 'P', 'S', 'I', 'M', 'G', '\0'}, IMAGE_VERSION, (uint32_t)commands.size(), (uint32_t)labelIndex.size(), (uint32_t)strings.size(), hash};
+		std::string tempName = imageName + ".tmp" + std::to_string(getpid());
+		std::ofstream image(tempName, std::ios::binary);
+		image.write((const char *)&header, sizeof(header));
+		image.write((const char *)decoded.data(), decoded.size() * sizeof(DecodedCommand));
+		image.write((const char *)labelIndex.data(), labelIndex.size() * sizeof(int));
+		image.write(strings.data(), strings.size());
+		image.close();
+		if (!image || std::rename(tempName.c_str(), imageName.c_str()))
+		{
+			std::remove(tempName.c_str());
+			return false;
+		}
+		return true;
 	}
 
-	// perform store word operation
-	int sw(std::string r, std::string location, std::string unused1 = "")
+	// memory map the image and load the program from it, fails if it is missing, malformed or built from another source
+	bool loadImage(const std::string &imageName, uint64_t hash)
 	{
-		if (!checkRegister(r))
-			return 1;
-		int address = locateAddress(location);
-		if (address < 0)
-			return abs(address);
-		data[address] = registers[registerMap[r]];
-		PCnext = PCcurr + 1;
-		return 0;
+		int fd = open(imageName.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat st;
+		if (fstat(fd, &st) || st.st_size < (off_t)sizeof(ImageHeader))
+		{
+			close(fd);
+			return false;
+		}
+		size_t size = st.st_size;
+		void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (mapped == MAP_FAILED)
+			return false;
+
+		const char *image = (const char *)mapped;
+		ImageHeader header;
+		memcpy(&header, image, sizeof(header));
+		size_t decodedBytes = (size_t)header.commands * sizeof(DecodedCommand), labelBytes = (size_t)header.labels * sizeof(int);
+		bool valid = memcmp(header.magic, "MIPSIMG", 8) == 0 && header.version == IMAGE_VERSION && header.sourceHash == hash &&
+					 sizeof(header) + decodedBytes + labelBytes + header.stringBytes == size;
+		size_t owned = source.owned.size();
+		if (valid)
+		{
+			const char *p = image + sizeof(header);
+			decoded.resize(header.commands);
+			memcpy(decoded.data(), p, decodedBytes);
+			std::vector<int> labelIndex(header.labels);
+			memcpy(labelIndex.data(), p + decodedBytes, labelBytes);
+			p += decodedBytes + labelBytes;
+			// the commands view the strings copied out of the image
+			source.owned.emplace_back(p, header.stringBytes);
+			p = source.owned.back().data();
+			const char *end = p + header.stringBytes;
+
+			// view the next null terminated string, if one is left
+			auto next = [&](std::string_view &s)
+			{
+				const char *q = (const char *)memchr(p, '\0', end - p);
+				if (q == nullptr)
+					return false;
+				s = std::string_view(p, q - p);
+				p = q + 1;
+				return true;
+			};
+			commands.resize(header.commands);
+			for (auto &command : commands)
+				for (auto &s : command)
+					valid = valid && next(s);
+			std::string_view label;
+			for (uint32_t i = 0; i < header.labels && valid; ++i)
+				if ((valid = next(label)))
+					address[std::string(label)] = labelIndex[i];
+			valid = valid && p == end;
+		}
+		munmap(mapped, size);
+		if (!valid)
+		{
+			source.owned.resize(owned);
+			decoded.clear();
+			commands.clear();
+			address.clear();
+		}
+		else
+			source.unmap();
+		return valid;
 	}
 
-	int locateAddress(std::string location)
+	// split a memory operand into base register and offset: -3 for an unknown register, -4 for a malformed offset
+	int decodeLocation(std::string location, int &base, int &offset)
 	{
-		if (location.back() == ')')
+		if (!location.empty() && location.back() == ')')
 		{
 			try
 			{
-				int lparen = location.find('('), offset = stoi(lparen == 0 ? "0" : location.substr(0, lparen));
+				int lparen = location.find('(');
+				offset = stoi(lparen == 0 ? "0" : location.substr(0, lparen));
 				std::string reg = location.substr(lparen + 1);
 				reg.pop_back();
-				if (!checkRegister(reg))
-					return -3;
-				int address = registers[registerMap[reg]] + offset;
-				if (address % 4 || address < int(4 * commands.size()) || address >= MAX)
-					return -3;
-				return address / 4;
+				base = lookupRegister(reg);
+				return base < 0 ? -3 : 0;
 			}
 			catch (std::exception &e)
 			{
@@ -192,10 +570,10 @@ struct MIPS_Architecture
 		}
 		try
 		{
-			int address = stoi(location);
-			if (address % 4 || address < int(4 * commands.size()) || address >= MAX)
-				return -3;
-			return address / 4;
+			// $zero is never written, so an absolute address is an offset from it
+			offset = stoi(location);
+			base = 0;
+			return 0;
 		}
 		catch (std::exception &e)
 		{
@@ -203,189 +581,527 @@ struct MIPS_Architecture
 		}
 	}
 
-	// perform add immediate operation
-	int addi(std::string r1, std::string r2, std::string num)
+	// index of the register, -1 if it is not a valid one
+	int lookupRegister(std::string_view r)
 	{
-		if (!checkRegisters({r1, r2}) || registerMap[r1] == 0)
-			return 1;
-		try
+		return registerMap[r];
+	}
+
+	// decode a command, performing all the checks that do not depend on the machine state
+	DecodedCommand decodeCommand(std::array<std::string_view, 4> &command)
+	{
+		DecodedCommand d = {OP_ERROR, 0, 0, 0, SYNTAX_ERROR};
+		auto fail = [&](int code)
 		{
-			registers[registerMap[r1]] = registers[registerMap[r2]] + stoi(num);
-			PCnext = PCcurr + 1;
-			return 0;
+			d.op = OP_ERROR;
+			d.imm = code;
+			return d;
+		};
+		// resolve a branch or jump label: a malformed label is a syntax error, an undefined or repeated one an invalid label
+		auto label = [&](std::string_view l)
+		{
+			if (!checkLabel(l))
+				return -SYNTAX_ERROR;
+			auto it = address.find(std::string(l));
+			return it == address.end() || it->second == -1 ? -INVALID_LABEL : it->second;
+		};
+		int op = instructions[command[0]];
+		int r1 = lookupRegister(command[1]), r2 = lookupRegister(command[2]);
+		if (op == OP_ADD || op == OP_SUB || op == OP_MUL || op == OP_SLT)
+		{
+			int r3 = lookupRegister(command[3]);
+			if (r1 <= 0 || r2 < 0 || r3 < 0)
+				return fail(INVALID_REGISTER);
+			d.op = op;
+			d.rd = r1, d.rs = r2, d.rt = r3;
 		}
-		catch (std::exception &e)
+		else if (op == OP_ADDI)
+		{
+			if (r1 <= 0 || r2 < 0)
+				return fail(INVALID_REGISTER);
+			try
+			{
+				d.imm = stoi(std::string(command[3]));
+			}
+			catch (std::exception &e)
+			{
+				return fail(SYNTAX_ERROR);
+			}
+			d.op = OP_ADDI;
+			d.rd = r1, d.rs = r2;
+		}
+		else if (op == OP_BEQ || op == OP_BNE)
 		{
-			return 4;
+			int target = label(command[3]);
+			if (target < 0)
+				return fail(-target);
+			if (r1 < 0 || r2 < 0)
+				return fail(INVALID_REGISTER);
+			d.op = op;
+			d.rs = r1, d.rt = r2;
+			d.imm = target;
 		}
+		else if (op == OP_J)
+		{
+			int target = label(command[1]);
+			if (target < 0)
+				return fail(-target);
+			d.op = OP_J;
+			d.imm = target;
+		}
+		else if (op == OP_LW || op == OP_SW)
+		{
+			if (r1 < 0 || (op == OP_LW && r1 == 0))
+				return fail(INVALID_REGISTER);
+			int base = 0, offset = 0, ret = decodeLocation(std::string(command[2]), base, offset);
+			if (ret < 0)
+				return fail(-ret);
+			d.op = op;
+			d.rd = r1, d.rs = base;
+			d.imm = offset;
+		}
+		return d;
 	}
 
-	// checks if label is valid
-	inline bool checkLabel(std::string str)
+	// construct the decoded commands from the parsed commands and labels, large programs are decoded in parallel ranges
+	void decodeCommands()
 	{
-		return str.size() > 0 && isalpha(str[0]) && all_of(++str.begin(), str.end(), [](char c)
-														   { return (bool)isalnum(c); }) &&
-			   instructions.find(str) == instructions.end();
+		int n = commands.size(), threads = workerThreads(n, PARALLEL_COMMANDS);
+		decoded.resize(n);
+		auto decodeRange = [this](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				decoded[i] = decodeCommand(commands[i]);
+		};
+		std::vector<std::thread> workers;
+		for (int i = 1; i < threads; ++i)
+			workers.emplace_back(decodeRange, (long long)n * i / threads, (long long)n * (i + 1) / threads);
+		decodeRange(0, n / threads);
+		for (auto &worker : workers)
+			worker.join();
 	}
 
-	// checks if the register is a valid one
-	inline bool checkRegister(std::string r)
+	// mark the commands which are targeted by a valid label
+	std::vector<bool> labelTargets()
 	{
-		return registerMap.find(r) != registerMap.end();
+		std::vector<bool> target(commands.size() + 1, false);
+		for (auto &label : address)
+			if (label.second >= 0)
+				target[label.second] = true;
+		return target;
 	}
 
-	// checks if all of the registers are valid or not
-	bool checkRegisters(std::vector<std::string> regs)
+	/*
+		find the sequences of commands that are run as superinstructions:
+		addi + slt + bne (loop tail) and addi + lw (address computation),
+		a sequence is fused only if all its commands decoded and no label targets its interior
+	*/
+	void fuseCommands()
 	{
-		return std::all_of(regs.begin(), regs.end(), [&](std::string r)
-						   { return checkRegister(r); });
+		int n = decoded.size();
+		fused.assign(n, FUSE_NONE);
+		std::vector<bool> target = labelTargets();
+
+		auto matches = [&](int i, std::initializer_list<uint8_t> ops)
+		{
+			if (i + (int)ops.size() > n)
+				return false;
+			int k = 0;
+			for (uint8_t op : ops)
+			{
+				if (decoded[i + k].op != op || (k > 0 && target[i + k]))
+					return false;
+				++k;
+			}
+			return true;
+		};
+		for (int i = 0; i < n; ++i)
+		{
+			if (matches(i, {OP_ADDI, OP_SLT, OP_BNE}))
+				fused[i] = FUSE_ADDI_SLT_BNE, i += 2;
+			else if (matches(i, {OP_ADDI, OP_LW}))
+				fused[i] = FUSE_ADDI_LW, i += 1;
+		}
 	}
 
-	/*
-		handle all exit codes:
-		0: correct execution
-		1: register provided is incorrect
-		2: invalid label
-		3: unaligned or invalid address
-		4: syntax error
-		5: commands exceed memory limit
-	*/
-	void handleExit(exit_code code, int cycleCount)
+	// execute a single decoded command, the only check left is the runtime memory address
+	exit_code executeDecoded(const DecodedCommand &d)
 	{
-		std::cout << '\n';
-		switch (code)
+		uint32_t address;
+		switch (d.op)
 		{
-		case 1:
-			std::cerr << "Invalid register provided or syntax error in providing register\n";
+		case OP_ADD:
+			registers[d.rd] = registers[d.rs] + registers[d.rt];
 			break;
-		case 2:
-			std::cerr << "Label used not defined or defined too many times\n";
+		case OP_SUB:
+			registers[d.rd] = registers[d.rs] - registers[d.rt];
 			break;
-		case 3:
-			std::cerr << "Unaligned or invalid memory address specified\n";
+		case OP_MUL:
+			registers[d.rd] = registers[d.rs] * registers[d.rt];
 			break;
-		case 4:
-			std::cerr << "Syntax error encountered\n";
+		case OP_SLT:
+			registers[d.rd] = registers[d.rs] < registers[d.rt];
 			break;
-		case 5:
-			std::cerr << "Memory limit exceeded\n";
+		case OP_ADDI:
+			registers[d.rd] = registers[d.rs] + d.imm;
 			break;
-		default:
+		case OP_BEQ:
+			PCnext = registers[d.rs] == registers[d.rt] ? d.imm : PCcurr + 1;
+			return SUCCESS;
+		case OP_BNE:
+			PCnext = registers[d.rs] != registers[d.rt] ? d.imm : PCcurr + 1;
+			return SUCCESS;
+		case OP_J:
+			PCnext = d.imm;
+			return SUCCESS;
+		case OP_LW:
+		case OP_SW:
+			address = (uint32_t)registers[d.rs] + d.imm;
+			if (!validAddress(address))
+				return INVALID_ADDRESS;
+			if (d.op == OP_LW)
+				registers[d.rd] = data.read(address / 4);
+			else
+				data.write(address / 4, registers[d.rd]);
 			break;
+		default:
+			return (exit_code)d.imm;
 		}
-		if (code != 0)
+		PCnext = PCcurr + 1;
+		return SUCCESS;
+	}
+
+	// execute the commands sequentially (no pipelining)
+	void executeCommandsUnpipelined()
+	{
+		if (4 * commands.size() >= memoryLimit)
 		{
-			std::cerr << "Error encountered at:\n";
-			for (auto &s : commands[PCcurr])
-				std::cerr << s << ' ';
-			std::cerr << '\n';
+			handleExit(MEMORY_ERROR, 0);
+			return;
 		}
-		std::cout << "\nFollowing are the non-zero data values:\n";
-		for (int i = 0; i < MAX / 4; ++i)
-			if (data[i] != 0)
-				std::cout << 4 * i << '-' << 4 * i + 3 << std::hex << ": " << data[i] << '\n'
-						  << std::dec;
-		std::cout << "\nTotal number of cycles: " << cycleCount << '\n';
-		std::cout << "Count of instructions executed:\n";
-		for (int i = 0; i < (int)commands.size(); ++i)
+
+		int clockCycles = 0;
+		while (PCcurr < (int)decoded.size())
 		{
-			std::cout << commandCount[i] << " times:\t";
-			for (auto &s : commands[i])
-				std::cout << s << ' ';
-			std::cout << '\n';
+			++clockCycles;
+			exit_code ret = executeDecoded(decoded[PCcurr]);
+			if (ret != SUCCESS)
+			{
+				handleExit(ret, clockCycles);
+				return;
+			}
+			++commandCount[PCcurr];
+			PCcurr = PCnext;
+			if (printCycles)
+				printRegisters(clockCycles);
 		}
+		handleExit(SUCCESS, clockCycles);
 	}
 
-	// parse the command assuming correctly formatted MIPS instruction (or label)
-	void parseCommand(std::string line)
+#if defined(__GNUC__)
+	/*
+		execute the commands sequentially using direct-threaded dispatch (computed goto):
+		every decoded command is bound to the address of its handler and each handler jumps
+		straight to the handler of the next command, an extra halt handler marks the end;
+		fused sequences still count and print every original command they execute
+	*/
+	void executeCommandsThreaded()
 	{
-		// strip until before the comment begins
-		line = line.substr(0, line.find('#'));
-		std::vector<std::string> command;
-		boost::tokenizer<boost::char_separator<char>> tokens(line, boost::char_separator<char>(", \t"));
-		for (auto &s : tokens)
-			command.push_back(s);
-		// empty line or a comment only line
-		if (command.empty())
-			return;
-		else if (command.size() == 1)
+		if (4 * commands.size() >= memoryLimit)
 		{
-			std::string label = command[0].back() == ':' ? command[0].substr(0, command[0].size() - 1) : "?";
-			if (address.find(label) == address.end())
-				address[label] = commands.size();
-			else
-				address[label] = -1;
-			command.clear();
+			handleExit(MEMORY_ERROR, 0);
+			return;
 		}
-		else if (command[0].back() == ':')
+
+		static void *const labels[] = {&&op_add, &&op_sub, &&op_mul, &&op_slt, &&op_addi, &&op_beq, &&op_bne, &&op_j, &&op_lw, &&op_sw, &&op_error};
+		static void *const fusedLabels[] = {nullptr, &&fuse_addi_slt_bne, &&fuse_addi_lw};
+		int n = decoded.size();
+		std::vector<void *> handlers(n + 1);
+		for (int i = 0; i < n; ++i)
+			handlers[i] = useFusion && fused[i] != FUSE_NONE ? fusedLabels[fused[i]] : labels[decoded[i].op];
+		handlers[n] = &&halt;
+
+		int clockCycles = 0;
+		uint32_t addr;
+		const DecodedCommand *d;
+		exit_code ret;
+
+#define DISPATCH()                    \
+	{                                 \
+		d = decoded.data() + PCcurr;  \
+		goto *handlers[PCcurr];       \
+	}
+#define NEXT(target)                        \
+	{                                       \
+		++commandCount[PCcurr];             \
+		PCcurr = (target);                  \
+		if (printCycles)                    \
+			printRegisters(clockCycles);    \
+		DISPATCH();                         \
+	}
+#define STEP()                              \
+	{                                       \
+		++commandCount[PCcurr];             \
+		++PCcurr;                           \
+		if (printCycles)                    \
+			printRegisters(clockCycles);    \
+		++clockCycles;                      \
+		++d;                                \
+	}
+
+		DISPATCH();
+	op_add:
+		++clockCycles;
+		registers[d->rd] = registers[d->rs] + registers[d->rt];
+		NEXT(PCcurr + 1);
+	op_sub:
+		++clockCycles;
+		registers[d->rd] = registers[d->rs] - registers[d->rt];
+		NEXT(PCcurr + 1);
+	op_mul:
+		++clockCycles;
+		registers[d->rd] = registers[d->rs] * registers[d->rt];
+		NEXT(PCcurr + 1);
+	op_slt:
+		++clockCycles;
+		registers[d->rd] = registers[d->rs] < registers[d->rt];
+		NEXT(PCcurr + 1);
+	op_addi:
+		++clockCycles;
+		registers[d->rd] = registers[d->rs] + d->imm;
+		NEXT(PCcurr + 1);
+	op_beq:
+		++clockCycles;
+		NEXT(registers[d->rs] == registers[d->rt] ? d->imm : PCcurr + 1);
+	op_bne:
+		++clockCycles;
+		NEXT(registers[d->rs] != registers[d->rt] ? d->imm : PCcurr + 1);
+	op_j:
+		++clockCycles;
+		NEXT(d->imm);
+	op_lw:
+		++clockCycles;
+	op_lw_body:
+		addr = (uint32_t)registers[d->rs] + d->imm;
+		if (!validAddress(addr))
 		{
-			std::string label = command[0].substr(0, command[0].size() - 1);
-			if (address.find(label) == address.end())
-				address[label] = commands.size();
-			else
-				address[label] = -1;
-			command = std::vector<std::string>(command.begin() + 1, command.end());
+			ret = INVALID_ADDRESS;
+			goto error;
 		}
-		else if (command[0].find(':') != std::string::npos)
+		registers[d->rd] = data.read(addr / 4);
+		NEXT(PCcurr + 1);
+	op_sw:
+		++clockCycles;
+		addr = (uint32_t)registers[d->rs] + d->imm;
+		if (!validAddress(addr))
 		{
-			int idx = command[0].find(':');
-			std::string label = command[0].substr(0, idx);
-			if (address.find(label) == address.end())
-				address[label] = commands.size();
-			else
-				address[label] = -1;
-			command[0] = command[0].substr(idx + 1);
+			ret = INVALID_ADDRESS;
+			goto error;
 		}
-		else if (command[1][0] == ':')
-		{
-			if (address.find(command[0]) == address.end())
-				address[command[0]] = commands.size();
-			else
-				address[command[0]] = -1;
-			command[1] = command[1].substr(1);
-			if (command[1] == "")
-				command.erase(command.begin(), command.begin() + 2);
-			else
-				command.erase(command.begin(), command.begin() + 1);
-		}
-		if (command.empty())
-			return;
-		if (command.size() > 4)
-			for (int i = 4; i < (int)command.size(); ++i)
-				command[3] += " " + command[i];
-		command.resize(4);
-		commands.push_back(command);
+		data.write(addr / 4, registers[d->rd]);
+		NEXT(PCcurr + 1);
+	fuse_addi_slt_bne:
+		++clockCycles;
+		registers[d->rd] = registers[d->rs] + d->imm;
+		STEP();
+		registers[d->rd] = registers[d->rs] < registers[d->rt];
+		STEP();
+		NEXT(registers[d->rs] != registers[d->rt] ? d->imm : PCcurr + 1);
+	fuse_addi_lw:
+		++clockCycles;
+		registers[d->rd] = registers[d->rs] + d->imm;
+		STEP();
+		goto op_lw_body;
+	op_error:
+		++clockCycles;
+		ret = (exit_code)d->imm;
+	error:
+		handleExit(ret, clockCycles);
+		return;
+	halt:
+		handleExit(SUCCESS, clockCycles);
+
+#undef STEP
+#undef NEXT
+#undef DISPATCH
+	}
+#else
+	// computed goto is a GNU extension, fall back to the switch based interpreter
+	void executeCommandsThreaded()
+	{
+		executeCommandsUnpipelined();
 	}
+#endif
 
-	// construct the commands vector from the input file
-	void constructCommands(std::ifstream &file)
+#ifdef MIPS_JIT_SUPPORTED
+	/*
+		translate the basic block starting at the given command into x86-64: the block ends after a branch
+		or jump, or before a label target or a command that failed to decode; lw and sw check their
+		address inline and leave the block before executing if it is invalid or a sw hits an unallocated page
+	*/
+	void compileBlock(int start, std::vector<bool> &target)
 	{
-		std::string line;
-		while (getline(file, line))
-			parseCommand(line);
-		file.close();
+		X86Emitter e;
+		int n = decoded.size(), pc = start;
+		bool closed = false;
+		for (; pc < n; ++pc)
+		{
+			const DecodedCommand &d = decoded[pc];
+			if (d.op == OP_ERROR || (pc > start && target[pc]))
+				break;
+			std::vector<size_t> fail, missing;
+			size_t done;
+			switch (d.op)
+			{
+			case OP_ADD:
+			case OP_SUB:
+			case OP_MUL:
+				e.movEaxReg(d.rs);
+				if (d.op == OP_ADD)
+					e.addEaxReg(d.rt);
+				else if (d.op == OP_SUB)
+					e.subEaxReg(d.rt);
+				else
+					e.imulEaxReg(d.rt);
+				e.movRegEax(d.rd);
+				break;
+			case OP_SLT:
+				e.movEaxReg(d.rs);
+				e.cmpEaxReg(d.rt);
+				e.setlEax();
+				e.movRegEax(d.rd);
+				break;
+			case OP_ADDI:
+				e.movEaxReg(d.rs);
+				e.addEaxImm(d.imm);
+				e.movRegEax(d.rd);
+				break;
+			case OP_LW:
+			case OP_SW:
+				// check the byte address in eax, then walk the page directory and table with it
+				e.movEaxReg(d.rs);
+				e.addEaxImm(d.imm);
+				e.testAlImm(3);
+				fail = {e.jcc(X86Emitter::JNE)};
+				e.cmpEaxImm(4 * n);
+				fail.push_back(e.jcc(X86Emitter::JB));
+				if (memoryLimit < (1ULL << 32))
+				{
+					e.cmpEaxImm((uint32_t)memoryLimit);
+					fail.push_back(e.jcc(X86Emitter::JAE));
+				}
+				e.movEcxEax();
+				e.shrEcx(2 + PagedMemory::PAGE_BITS + PagedMemory::TABLE_BITS);
+				e.loadTable();
+				e.testR8();
+				missing = {e.jcc(X86Emitter::JZ)};
+				e.movEcxEax();
+				e.shrEcx(2 + PagedMemory::PAGE_BITS);
+				e.andEcxImm(PagedMemory::TABLE_PAGES - 1);
+				e.loadPage();
+				e.testR8();
+				missing.push_back(e.jcc(X86Emitter::JZ));
+				e.andEaxImm(4 * PagedMemory::PAGE_WORDS - 1);
+				if (d.op == OP_LW)
+				{
+					// a page that was never written reads as 0
+					e.loadWord();
+					done = e.jmp();
+					for (size_t jump : missing)
+						e.patch(jump);
+					e.xorEcxEcx();
+					e.patch(done);
+					e.movRegEcx(d.rd);
+				}
+				else
+				{
+					// the interpreter allocates the page of a first store and copies a shared page
+					e.cmpR8Imm(4 * PagedMemory::PAGE_WORDS, 1);
+					fail.push_back(e.jcc(X86Emitter::JNE));
+					e.movEcxReg(d.rd);
+					e.storeWord();
+					fail.insert(fail.end(), missing.begin(), missing.end());
+				}
+				done = e.jmp();
+				for (size_t jump : fail)
+					e.patch(jump);
+				e.movEaxImm(-(pc + 1));
+				e.ret();
+				e.patch(done);
+				break;
+			}
+			// the counter update clobbers the flags, so it precedes the comparison of a branch
+			e.incCounter(pc);
+			if (d.op == OP_BEQ || d.op == OP_BNE)
+			{
+				e.movEaxReg(d.rs);
+				e.cmpEaxReg(d.rt);
+				e.movEaxImm(pc + 1);
+				e.movEcxImm(d.imm);
+				if (d.op == OP_BEQ)
+					e.cmoveEaxEcx();
+				else
+					e.cmovneEaxEcx();
+				e.ret();
+				closed = true;
+				break;
+			}
+			if (d.op == OP_J)
+			{
+				e.movEaxImm(d.imm);
+				e.ret();
+				closed = true;
+				break;
+			}
+		}
+		int length = pc - start + closed;
+		if (!closed)
+		{
+			e.movEaxImm(pc);
+			e.ret();
+		}
+		blocks[start] = length > 0 ? (CompiledBlock)jitMemory.install(e.code) : nullptr;
+		blockLength[start] = blocks[start] ? length : -1;
 	}
 
-	// execute the commands sequentially (no pipelining)
-	void executeCommandsUnpipelined()
+	/*
+		execute the commands sequentially, translating hot basic blocks (run at least jitThreshold times)
+		to native code; cold code, errors and runs printing every cycle are left to the interpreter
+	*/
+	void executeCommandsJIT()
 	{
-		if (commands.size() >= MAX / 4)
+		if (4 * commands.size() >= memoryLimit)
 		{
 			handleExit(MEMORY_ERROR, 0);
 			return;
 		}
 
-		int clockCycles = 0;
-		while (PCcurr < commands.size())
+		int n = decoded.size(), clockCycles = 0;
+		std::vector<bool> target = labelTargets();
+		blocks.assign(n, nullptr);
+		blockLength.assign(n, 0);
+		while (PCcurr < n)
 		{
-			++clockCycles;
-			std::vector<std::string> &command = commands[PCcurr];
-			if (instructions.find(command[0]) == instructions.end())
+			if (blocks[PCcurr])
 			{
-				handleExit(SYNTAX_ERROR, clockCycles);
-				return;
+				int start = PCcurr, next = blocks[PCcurr](registers, data.tables, commandCount.data());
+				if (next >= 0)
+				{
+					clockCycles += blockLength[start];
+					PCcurr = next;
+					continue;
+				}
+				// an address check failed or a page is missing, the interpreter executes that command
+				PCcurr = -next - 1;
+				clockCycles += PCcurr - start;
+			}
+			else if (!printCycles && blockLength[PCcurr] == 0 && commandCount[PCcurr] >= jitThreshold)
+			{
+				compileBlock(PCcurr, target);
+				continue;
 			}
-			exit_code ret = (exit_code) instructions[command[0]](*this, command[1], command[2], command[3]);
+			++clockCycles;
+			exit_code ret = executeDecoded(decoded[PCcurr]);
 			if (ret != SUCCESS)
 			{
 				handleExit(ret, clockCycles);
@@ -393,10 +1109,18 @@ struct MIPS_Architecture
 			}
 			++commandCount[PCcurr];
 			PCcurr = PCnext;
-			printRegisters(clockCycles);
+			if (printCycles)
+				printRegisters(clockCycles);
 		}
 		handleExit(SUCCESS, clockCycles);
 	}
+#else
+	// no native code generation on this platform, fall back to the threaded interpreter
+	void executeCommandsJIT()
+	{
+		executeCommandsThreaded();
+	}
+#endif
 
 	// print the register data in hexadecimal
 	void printRegisters(int clockCycle)
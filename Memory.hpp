@@ -0,0 +1,202 @@
+/**
+ * @file Memory.hpp
+ * sparse paged data memory shared by the simulators
+ */
+
+#ifndef __MEMORY_HPP__
+#define __MEMORY_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+/*
+	word addressed data memory covering the whole 32 bit byte address space: a directory of
+	1024 tables, each of 1024 pages of 1024 words (4 KB), allocated on the first write to them.
+	Reads of memory that was never written return 0 without allocating anything.
+	Word indices are taken modulo 2^30, like byte addresses wrap around at 2^32.
+	The allocated pages are exactly the pages that were written, so they are kept in a list and
+	dumps and comparisons only visit them; with logWrites set, the indices of the written words
+	are also recorded in order until clearWrites.
+	Copies share their pages copy-on-write: every page keeps a reference count in the word after
+	its data and a write to a page with more than one reference first gives the writer its own copy.
+*/
+struct PagedMemory
+{
+	static constexpr int PAGE_BITS = 10, TABLE_BITS = 10, DIRECTORY_BITS = 10;
+	static constexpr uint32_t PAGE_WORDS = 1u << PAGE_BITS, TABLE_PAGES = 1u << TABLE_BITS, TABLES = 1u << DIRECTORY_BITS;
+	static constexpr uint32_t WORDS = PAGE_WORDS * TABLE_PAGES * TABLES;
+
+	struct Table
+	{
+		int *pages[TABLE_PAGES];
+	};
+	Table *tables[TABLES] = {nullptr};
+	// page numbers (word index / PAGE_WORDS) of the allocated pages, sorted when pagesSorted
+	std::vector<uint32_t> pages;
+	bool pagesSorted = true;
+	bool logWrites = false;
+	std::vector<uint32_t> writes;
+
+	PagedMemory() = default;
+
+	PagedMemory(const PagedMemory &other)
+	{
+		*this = other;
+	}
+
+	// share the pages of other, only the tables are copied
+	PagedMemory &operator=(const PagedMemory &other)
+	{
+		if (this == &other)
+			return *this;
+		clear();
+		for (uint32_t t = 0; t < TABLES; ++t)
+		{
+			if (other.tables[t] == nullptr)
+				continue;
+			tables[t] = new Table(*other.tables[t]);
+			for (int *page : tables[t]->pages)
+				if (page != nullptr)
+					++page[PAGE_WORDS];
+		}
+		pages = other.pages;
+		pagesSorted = other.pagesSorted;
+		logWrites = other.logWrites;
+		writes = other.writes;
+		return *this;
+	}
+
+	~PagedMemory()
+	{
+		clear();
+	}
+
+	// drop one reference to the page, freeing it with the last one
+	static void release(int *page)
+	{
+		if (page != nullptr && --page[PAGE_WORDS] == 0)
+			delete[] page;
+	}
+
+	// release every page
+	void clear()
+	{
+		for (auto &table : tables)
+		{
+			if (table == nullptr)
+				continue;
+			for (int *page : table->pages)
+				release(page);
+			delete table;
+			table = nullptr;
+		}
+		pages.clear();
+		pagesSorted = true;
+		writes.clear();
+	}
+
+	// page holding the word, nullptr if it was never written
+	const int *page(uint32_t index) const
+	{
+		index &= WORDS - 1;
+		const Table *table = tables[index >> (PAGE_BITS + TABLE_BITS)];
+		return table == nullptr ? nullptr : table->pages[(index >> PAGE_BITS) & (TABLE_PAGES - 1)];
+	}
+
+	// page holding the word, allocated (zeroed) if it was never written and copied if it is shared
+	int *touch(uint32_t index)
+	{
+		index &= WORDS - 1;
+		Table *&table = tables[index >> (PAGE_BITS + TABLE_BITS)];
+		if (table == nullptr)
+			table = new Table();
+		int *&page = table->pages[(index >> PAGE_BITS) & (TABLE_PAGES - 1)];
+		if (page == nullptr)
+		{
+			page = new int[PAGE_WORDS + 1]();
+			page[PAGE_WORDS] = 1;
+			if (!pages.empty() && pages.back() > (index >> PAGE_BITS))
+				pagesSorted = false;
+			pages.push_back(index >> PAGE_BITS);
+		}
+		else if (page[PAGE_WORDS] > 1)
+		{
+			int *copy = new int[PAGE_WORDS + 1];
+			memcpy(copy, page, PAGE_WORDS * sizeof(int));
+			copy[PAGE_WORDS] = 1;
+			--page[PAGE_WORDS];
+			page = copy;
+		}
+		return page;
+	}
+
+	int read(uint32_t index) const
+	{
+		const int *p = page(index);
+		return p == nullptr ? 0 : p[index & (PAGE_WORDS - 1)];
+	}
+
+	void write(uint32_t index, int value)
+	{
+		(*this)[index] = value;
+	}
+
+	// reference to the word for writing, allocates its page
+	int &operator[](uint32_t index)
+	{
+		if (logWrites)
+			writes.push_back(index & (WORDS - 1));
+		return touch(index)[index & (PAGE_WORDS - 1)];
+	}
+
+	// forget the words written so far
+	void clearWrites()
+	{
+		writes.clear();
+	}
+
+	// allocated page numbers in increasing order
+	const std::vector<uint32_t> &allocatedPages()
+	{
+		if (!pagesSorted)
+			std::sort(pages.begin(), pages.end()), pagesSorted = true;
+		return pages;
+	}
+
+	// call f(index, value) for every non-zero word in increasing order of index
+	template <typename F>
+	void forEachNonZero(F f)
+	{
+		for (uint32_t p : allocatedPages())
+		{
+			const int *words = page(p * PAGE_WORDS);
+			for (uint32_t w = 0; w < PAGE_WORDS; ++w)
+				if (words[w] != 0)
+					f(p * PAGE_WORDS + w, words[w]);
+		}
+	}
+
+	// call f(index, value, otherValue) for every word differing from other in increasing order of index
+	template <typename F>
+	void diff(PagedMemory &other, F f)
+	{
+		const std::vector<uint32_t> &mine = allocatedPages(), &theirs = other.allocatedPages();
+		std::vector<uint32_t> both;
+		std::set_union(mine.begin(), mine.end(), theirs.begin(), theirs.end(), std::back_inserter(both));
+		for (uint32_t p : both)
+		{
+			const int *a = page(p * PAGE_WORDS), *b = other.page(p * PAGE_WORDS);
+			for (uint32_t w = 0; w < PAGE_WORDS; ++w)
+			{
+				int x = a == nullptr ? 0 : a[w], y = b == nullptr ? 0 : b[w];
+				if (x != y)
+					f(p * PAGE_WORDS + w, x, y);
+			}
+		}
+	}
+};
+
+#endif
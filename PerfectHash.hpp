@@ -0,0 +1,80 @@
+/**
+ * @file PerfectHash.hpp
+ * compile time perfect hash tables for the opcode and register names
+ */
+
+#ifndef __PERFECT_HASH_HPP__
+#define __PERFECT_HASH_HPP__
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+/*
+	perfect hash table of N short names (at most 7 characters) built at compile time: the seed
+	of the hash is searched until no two names share one of the SIZE slots, so a lookup is one
+	hash of the name and one comparison with the name stored in its slot
+*/
+template <int N, int SIZE>
+struct PerfectHash
+{
+	struct Entry
+	{
+		char name[8];
+		int value;
+	};
+	Entry table[SIZE];
+	uint32_t seed;
+
+	static constexpr uint32_t hash(std::string_view s, uint32_t seed)
+	{
+		uint32_t h = seed;
+		for (char c : s)
+			h = (h ^ (uint8_t)c) * 16777619u;
+		return (h ^ (h >> 15)) % SIZE;
+	}
+
+	constexpr PerfectHash(const std::pair<std::string_view, int> (&keys)[N]) : table(), seed(0)
+	{
+		for (bool collision = true; collision; ++seed)
+		{
+			for (auto &entry : table)
+				entry = {{0}, -1};
+			collision = false;
+			for (int i = 0; i < N && !collision; ++i)
+			{
+				Entry &entry = table[hash(keys[i].first, seed)];
+				if (entry.value != -1)
+				{
+					collision = true;
+					break;
+				}
+				for (int k = 0; k < (int)keys[i].first.size(); ++k)
+					entry.name[k] = keys[i].first[k];
+				entry.value = keys[i].second;
+			}
+		}
+		--seed;
+	}
+
+	// value of the name, -1 if it is not in the table
+	constexpr int operator[](std::string_view s) const
+	{
+		if (s.size() > 7)
+			return -1;
+		const Entry &entry = table[hash(s, seed)];
+		if (entry.name[s.size()] != '\0')
+			return -1;
+		for (int k = 0; k < (int)s.size(); ++k)
+			if (entry.name[k] != s[k])
+				return -1;
+		return entry.value;
+	}
+
+	constexpr bool contains(std::string_view s) const
+	{
+		return (*this)[s] != -1;
+	}
+};
+
+#endif
@@ -0,0 +1,1125 @@
+/**
+ * @file Pipeline.hpp
+ * @author Mallika Prabhakar and Sayam Sethi
+ * five stage pipeline shared by final_part1.hpp, final_part2.hpp and work.hpp
+ */
+
+#ifndef __PIPELINE_HPP__
+#define __PIPELINE_HPP__
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <exception>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <thread>
+#include <boost/tokenizer.hpp>
+#include "Memory.hpp"
+#include "PerfectHash.hpp"
+#include "Checkpoint.hpp"
+#include "Cache.hpp"
+#include "BranchPredictor.hpp"
+#include "BranchTargetBuffer.hpp"
+using namespace std;
+
+
+/*
+	pipeline latch: the control signals are 0 or 1 when set and 2 when not, they are packed with the
+	ALU operation into one word in front of the data fields, PredictTaken is the direction fetch predicted
+	for a branch or whether it followed a j; writes and loads are the register masks
+	of the scoreboard, handed on with the latches of the instruction
+*/
+struct Latch
+{
+	unsigned ALUSrc:2,ALUOp:4,RegDst:2,MemWrite:2,MemRead:2,WriteBack:2,MemtoReg:2,ALUtoMem:2,Branch:2,TakeBranch:2,PredictTaken:2;
+	int8_t destregister=-1;
+	int8_t destregister0=-1,destregister1=-1;
+	int data1=0,data2=0;
+	int destaddress=-1;
+	int offset=0;
+	int aluresult=0;
+	int addresult=0;
+	int memdata0=0,memdata1=0;
+	int pc=-1;
+	uint32_t writes=0,loads=0;
+
+	Latch():ALUSrc(2),ALUOp(0),RegDst(2),MemWrite(2),MemRead(2),WriteBack(2),MemtoReg(2),ALUtoMem(2),Branch(2),TakeBranch(2),PredictTaken(2) {}
+};
+
+void ClearLatchValues(Latch* L)
+{
+	*L=Latch();
+}
+
+/*
+	queue of the fetched program counters waiting for the ID stage, a ring buffer with room for one entry
+	per command: between two flushes the fetch only goes forward, so it never holds more, except when it
+	follows predicted branches and then stops while the queue is full. While a branch is resolved its
+	entries are held out of the sight of ID for the cycle, and replayed in fetch
+*/
+struct FetchQueue
+{
+	//taken is the prediction for a branch fetched with a predictor
+	struct Entry
+	{
+		int pc;
+		bool taken;
+	};
+	std::vector<Entry> entries;
+	uint32_t head=0,count=0;
+	bool held=false;
+
+	void reserve(size_t commands) { entries.assign(commands+1,Entry{0,false}); head=count=0; held=false; }
+	bool valid() const { return head<entries.size() && count<=entries.size(); }
+
+	bool empty() const { return held || count==0; }
+	bool full() const { return count==entries.size(); }
+	int front() const { return entries[head].pc; }
+	bool frontTaken() const { return entries[head].taken; }
+	void pop() { if(++head==entries.size()) head=0; count--; }
+	void push(int pc,bool taken=false)
+	{
+		uint32_t tail=head+count++;
+		entries[tail>=entries.size() ? tail-entries.size() : tail]={pc,taken};
+	}
+	void flush() { count=0; held=false; }
+	void hold() { held=true; }
+	void replay() { held=false; }
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(entries);
+		a.field(head); a.field(count); a.field(held);
+	}
+};
+
+/*
+	the pipelined simulators are this engine specialised by a policy struct of compile-time constants:
+		forwarding: ID reads its operands from the bypass registers written by the ALU and MEM stages instead
+			of waiting for the write back, which also makes the non-blocking data cache available
+		memoryHazards: a lw waits in ID while a sw to the same word is in flight
+		jumps: j is decoded and taken in the pipeline, without it a j holds the ID stage for ever
+		idleTermination: the run ends once a cycle leaves every stage idle, else in the third cycle with an empty decode queue
+		cycleHeader: every cycle of the trace starts with its number and prints the registers in hexadecimal
+		checkpointVariant: tags the checkpoint files, only the same variant accepts them
+	Predictor is the type of the branch predictor, a predictor policy of BranchPredictor.hpp has its calls in
+	the fetch inlined while the default BranchPredictor takes any predictor chosen at run time
+*/
+template <class Policy, class Predictor = BranchPredictor>
+struct PipelinedMIPS
+{
+	int registers[32] = {0}, PCcurr = 0,PCnext=0;
+
+	std::unordered_map<std::string, int> address;
+	//ALU operation of every instruction name (1-4 add,sub,mul,slt, then addi,lw,sw,beq,bne,j), built at compile time
+	static constexpr PerfectHash<10, 32> instructions = PerfectHash<10, 32>({{"add", 1}, {"sub", 2}, {"mul", 3}, {"slt", 4}, {"addi", 5}, {"lw", 6}, {"sw", 7}, {"beq", 8}, {"bne", 9}, {"j", 10}});
+	//index of every register name, numeric and conventional, built at compile time
+	static constexpr PerfectHash<64, 512> registerMap = PerfectHash<64, 512>({
+		{"$0", 0}, {"$1", 1}, {"$2", 2}, {"$3", 3}, {"$4", 4}, {"$5", 5}, {"$6", 6}, {"$7", 7},
+		{"$8", 8}, {"$9", 9}, {"$10", 10}, {"$11", 11}, {"$12", 12}, {"$13", 13}, {"$14", 14}, {"$15", 15},
+		{"$16", 16}, {"$17", 17}, {"$18", 18}, {"$19", 19}, {"$20", 20}, {"$21", 21}, {"$22", 22}, {"$23", 23},
+		{"$24", 24}, {"$25", 25}, {"$26", 26}, {"$27", 27}, {"$28", 28}, {"$29", 29}, {"$30", 30}, {"$31", 31},
+		{"$zero", 0}, {"$at", 1}, {"$v0", 2}, {"$v1", 3}, {"$a0", 4}, {"$a1", 5}, {"$a2", 6}, {"$a3", 7},
+		{"$t0", 8}, {"$t1", 9}, {"$t2", 10}, {"$t3", 11}, {"$t4", 12}, {"$t5", 13}, {"$t6", 14}, {"$t7", 15},
+		{"$s0", 16}, {"$s1", 17}, {"$s2", 18}, {"$s3", 19}, {"$s4", 20}, {"$s5", 21}, {"$s6", 22}, {"$s7", 23},
+		{"$t8", 24}, {"$t9", 25}, {"$k0", 26}, {"$k1", 27}, {"$gp", 28}, {"$sp", 29}, {"$s8", 30}, {"$ra", 31}});
+	//the data memory covers the whole 32 bit address space, the pipelines do not check the addresses of lw/sw
+	PagedMemory data;
+	std::vector<std::vector<std::string>> commands;
+	std::vector<int> commandCount;
+	//the operands of a command as the ID stage needs them, decoded on its first visit to the command
+	struct Decoded
+	{
+		enum {UNDECODED,ALU,ADDI,LW,SW,BRANCH,JUMP,OTHER};
+		uint8_t op=UNDECODED,aluOp=0;
+		int8_t rd=0,rs=0,rt=0;
+		int imm=0;
+		//masks of the registers read and written
+		uint32_t sources=0,dest=0;
+	};
+	std::vector<Decoded> decoded;
+	enum exit_code
+	{
+		SUCCESS = 0,
+		INVALID_REGISTER,
+		INVALID_LABEL,
+		INVALID_ADDRESS,
+		SYNTAX_ERROR,
+		MEMORY_ERROR
+	};
+
+	//state of executeCommandPipelined, kept between calls so that a run can be stopped and resumed
+	struct PipelineState
+	{
+		//the values on the bypass of the forwarding variant
+		int Tempregisters[32]={0};
+		//words with a sw in flight, for memoryHazards
+		map<int,int> MemoryWrite;
+		bool HaltPC=false;
+		int PCSrc=2;
+		//double buffered latches: slot holds the buffer of every latch, handing a latch on to the next
+		//one swaps their buffers and leaves it with the emptied buffer of the next one
+		enum {IDWB,ALUWB,MEMWB,IDMEM,ALUMEM,IDALU};
+		Latch buffers[6];
+		uint8_t slot[6]={IDWB,ALUWB,MEMWB,IDMEM,ALUMEM,IDALU};
+		int clockCycles=0;
+		//consecutive cycles with an empty decode queue, which end the run without idleTermination
+		int FinalCount=0;
+		int PCnew=0;
+		FetchQueue id_stage;
+		int stage_executed=0;
+		//cycles in which the data of the MEM stage and the fetch of fetchPC are ready, -1 before the lookup
+		int64_t memoryReady=-1;
+		int64_t fetchReady=0;
+		int fetchPC=-1;
+		//loads that missed in a non-blocking data cache, their register is written when the fill arrives unless
+		//a younger instruction wrote it in the meantime, which changed the generation of the register
+		struct PendingLoad
+		{
+			int reg,value;
+			uint32_t address;
+			int64_t ready;
+			uint32_t generation;
+		};
+		vector<PendingLoad> pendingLoads;
+		uint32_t fillPending=0;
+		//writes to every register by the ALU and MEM stages, for the non-blocking loads
+		uint32_t generation[32]={0};
+		//branches resolved with a predictor or in ID and how many of them were mispredicted; the cycles saved over
+		//stalling on every branch are the difference of the cycle counts of the two runs
+		uint64_t branches=0,mispredictions=0;
+		//branches taken in ID, and the cycles branches waited in ID for the operands of the comparator
+		uint64_t takenBranches=0,branchStalls=0;
+		//a j decoded after fetch took it from the BTB, counted as a removed bubble once the next cycle did not squash it
+		bool removedJump=false;
+	} pipeline;
+
+	//complete simulator state, the memory pages are shared copy-on-write with the simulator it was taken from
+	struct Checkpoint
+	{
+		int registers[32];
+		int PCcurr,PCnext;
+		std::vector<int> commandCount;
+		PagedMemory data;
+		PipelineState pipeline;
+		CacheHierarchy caches;
+		BranchTargetBuffer btb;
+		//a copy of the predictor and its geometry, 0 without one
+		std::shared_ptr<Predictor> predictor;
+		uint64_t predictorGeometry=0;
+
+		//lists the fields in the order of the checkpoint file, for CheckpointWriter and CheckpointReader
+		template <typename Archive>
+		void transfer(Archive &a)
+		{
+			a.field(registers);
+			a.field(PCcurr); a.field(PCnext);
+			a.field(commandCount);
+			a.field(data);
+			if constexpr(Policy::forwarding) a.field(pipeline.Tempregisters);
+			if constexpr(Policy::memoryHazards) a.field(pipeline.MemoryWrite);
+			a.field(pipeline.HaltPC);
+			a.field(pipeline.PCSrc);
+			a.field(pipeline.buffers); a.field(pipeline.slot);
+			a.field(pipeline.clockCycles);
+			if constexpr(Policy::idleTermination) a.field(pipeline.stage_executed);
+			else a.field(pipeline.FinalCount);
+			a.field(pipeline.PCnew);
+			pipeline.id_stage.transfer(a);
+			a.field(pipeline.memoryReady);
+			a.field(pipeline.fetchReady); a.field(pipeline.fetchPC);
+			if constexpr(Policy::forwarding)
+			{
+				a.field(pipeline.pendingLoads); a.field(pipeline.fillPending);
+				a.field(pipeline.generation);
+			}
+			a.field(pipeline.branches); a.field(pipeline.mispredictions);
+			a.field(pipeline.takenBranches); a.field(pipeline.branchStalls);
+			a.field(pipeline.removedJump);
+			caches.transfer(a);
+			btb.transfer(a);
+			a.field(predictorGeometry);
+			auto *hooks=checkpointHooks(predictor.get());
+			if(hooks && hooks->geometry()==predictorGeometry) hooks->transfer(a);
+		}
+	};
+
+	//with useCaches the instruction fetches and the lw/sw in the MEM stage go through caches and stall on misses,
+	//unless caches.mshrs.capacity is set with forwarding: then data misses are non-blocking and only the users of a loaded value wait;
+	//caches.prefetcher selects the data prefetcher and caches.useDram serves the misses through the DRAM controller model caches.dram
+	bool useCaches=false;
+	CacheHierarchy caches;
+	//with a predictor fetch follows the predicted direction of beq/bne instead of stalling decode until they are resolved
+	//in the MEM stage, which squashes the instructions after a mispredicted branch
+	std::shared_ptr<Predictor> predictor;
+	//once configured fetch only follows the targets the BTB holds: a hit takes a j in the fetch cycle and, without
+	//a predictor, predicts a beq/bne taken, which makes fetch speculative as with a predictor
+	BranchTargetBuffer btb;
+	//with earlyBranches beq/bne are resolved in ID by an equality comparator and only squash the fetched instructions
+	//of the other path; with forwarding the comparator waits for a result of the ALU stage and for a lw in the MEM stage
+	bool earlyBranches=false;
+
+	//checkpoints of the other pipelines hold other fields and are rejected
+	static const uint32_t CHECKPOINT_VARIANT=Policy::checkpointVariant;
+	//a checkpoint is written to checkpointFile every checkpointInterval cycles when it is set
+	int checkpointInterval=0;
+	std::string checkpointFile;
+	bool checkpointSaved=true;
+	std::unique_ptr<Checkpoint> pendingCheckpoint;
+	std::thread checkpointThread;
+
+	// constructor reading the program from the input file
+	PipelinedMIPS(std::ifstream &file)
+	{
+		constructCommands(file);
+		commandCount.assign(commands.size(), 0);
+		decoded.assign(commands.size(), Decoded());
+		pipeline.id_stage.reserve(commands.size());
+	}
+
+	/*
+		handle all exit codes:
+		0: correct execution
+		1: register provided is incorrect
+		2: invalid label
+		3: unaligned or invalid address
+		4: syntax error
+		5: commands exceed memory limit
+	*/
+	void handleExit(exit_code code, int cycleCount)
+	{
+		std::cout << '\n';
+		switch (code)
+		{
+		case 1:
+			std::cerr << "Invalid register provided or syntax error in providing register\n";
+			break;
+		case 2:
+			std::cerr << "Label used not defined or defined too many times\n";
+			break;
+		case 3:
+			std::cerr << "Unaligned or invalid memory address specified\n";
+			break;
+		case 4:
+			std::cerr << "Syntax error encountered\n";
+			break;
+		case 5:
+			std::cerr << "Memory limit exceeded\n";
+			break;
+		default:
+			break;
+		}
+		if (code != 0)
+		{
+			std::cerr << "Error encountered at:\n";
+			for (auto &s : commands[PCcurr])
+				std::cerr << s << ' ';
+			std::cerr << '\n';
+		}
+		std::cout << "\nFollowing are the non-zero data values:\n";
+		data.forEachNonZero([](uint32_t i, int value)
+							{ std::cout << 4ULL * i << '-' << 4ULL * i + 3 << std::hex << ": " << value << '\n'
+										<< std::dec; });
+		std::cout << "\nTotal number of cycles: " << cycleCount << '\n';
+		std::cout << "Count of instructions executed:\n";
+		for (int i = 0; i < (int)commands.size(); ++i)
+		{
+			std::cout << commandCount[i] << " times:\t";
+			for (auto &s : commands[i])
+				std::cout << s << ' ';
+			std::cout << '\n';
+		}
+	}
+
+	// parse the command assuming correctly formatted MIPS instruction (or label)
+	void parseCommand(std::string line)
+	{
+		// strip until before the comment begins
+		line = line.substr(0, line.find('#'));
+		std::vector<std::string> command;
+		boost::tokenizer<boost::char_separator<char>> tokens(line, boost::char_separator<char>(", \t"));
+		for (auto &s : tokens)
+			command.push_back(s);
+		// empty line or a comment only line
+		if (command.empty())
+			return;
+		else if (command.size() == 1)
+		{
+			std::string label = command[0].back() == ':' ? command[0].substr(0, command[0].size() - 1) : "?";
+			if (address.find(label) == address.end())
+				address[label] = commands.size();
+			else
+				address[label] = -1;
+			command.clear();
+		}
+		else if (command[0].back() == ':')
+		{
+			std::string label = command[0].substr(0, command[0].size() - 1);
+			if (address.find(label) == address.end())
+				address[label] = commands.size();
+			else
+				address[label] = -1;
+			command = std::vector<std::string>(command.begin() + 1, command.end());
+		}
+		else if (command[0].find(':') != std::string::npos)
+		{
+			int idx = command[0].find(':');
+			std::string label = command[0].substr(0, idx);
+			if (address.find(label) == address.end())
+				address[label] = commands.size();
+			else
+				address[label] = -1;
+			command[0] = command[0].substr(idx + 1);
+		}
+		else if (command[1][0] == ':')
+		{
+			if (address.find(command[0]) == address.end())
+				address[command[0]] = commands.size();
+			else
+				address[command[0]] = -1;
+			command[1] = command[1].substr(1);
+			if (command[1] == "")
+				command.erase(command.begin(), command.begin() + 2);
+			else
+				command.erase(command.begin(), command.begin() + 1);
+		}
+		if (command.empty())
+			return;
+		if (command.size() > 4)
+			for (int i = 4; i < (int)command.size(); ++i)
+				command[3] += " " + command[i];
+		command.resize(4);
+		commands.push_back(command);
+	}
+
+	// construct the commands vector from the input file
+	void constructCommands(std::ifstream &file)
+	{
+		std::string line;
+		while (getline(file, line))
+			parseCommand(line);
+		file.close();
+	}
+
+	//function written by us to find the offset and source register separately for load and store instructions.
+	pair<string,int> LoadAndStore(string location)
+	{
+		int lparen = location.find('('), offset = stoi(lparen == 0 ? "0" : location.substr(0, lparen));
+		std::string reg = location.substr(lparen + 1);
+		reg.pop_back();
+		return {reg,offset};
+	}
+
+	//whether beq/bne are fetched down a predicted path
+	bool speculative() const { return predictor || btb.enabled(); }
+
+	//the target fetch follows the command at pc to, -1 to go on with the next one: a j or a beq/bne predicted taken
+	//with a target inside the program, which comes from the BTB if there is one and else from the decoded command
+	int predictTarget(int pc)
+	{
+		const Decoded &d=decode(pc);
+		bool jump=d.op==Decoded::JUMP;
+		if(!jump && d.op!=Decoded::BRANCH) return -1;
+		int target;
+		if(btb.enabled()) target=btb.lookup(pc);
+		else if(jump) return -1;
+		else target=d.imm;
+		if(target<0 || target>=(int)commands.size()) return -1;
+		return jump || !predictor || predictor->predict(pc) ? target : -1;
+	}
+
+	//trains the BTB with a resolved branch, without a predictor a hit predicts taken so a branch not taken is dropped
+	void recordBranch(int pc,bool taken,int target)
+	{
+		if(taken) btb.insert(pc,target);
+		else if(!predictor) btb.erase(pc);
+	}
+
+	const Decoded &decode(int i)
+	{
+		Decoded &d=decoded[i];
+		if(d.op!=Decoded::UNDECODED) return d;
+		const vector<string> &ins=commands[i];
+		auto reg=[&](const string &r)
+		{
+			int index=registerMap[r];
+			return index<0 ? 0 : index;
+		};
+		uint8_t op=Decoded::OTHER;
+		int aluOp=instructions[ins[0]];
+		if(aluOp>=1 && aluOp<=4)
+		{
+			op=Decoded::ALU;
+			d.aluOp=aluOp;
+			d.rd=reg(ins[1]),d.rs=reg(ins[2]),d.rt=reg(ins[3]);
+			d.sources=1u<<d.rs|1u<<d.rt;
+			d.dest=1u<<d.rd;
+		}
+		else if(aluOp==5)
+		{
+			op=Decoded::ADDI;
+			d.rd=reg(ins[1]),d.rs=reg(ins[2]);
+			d.imm=stoi(ins[3]);
+			d.sources=1u<<d.rs;
+			d.dest=1u<<d.rd;
+		}
+		else if(aluOp==6 || aluOp==7)
+		{
+			pair<string,int> temp=LoadAndStore(ins[2]);
+			d.rs=reg(temp.first);
+			d.imm=temp.second;
+			d.sources=1u<<d.rs;
+			if(aluOp==6)
+			{
+				op=Decoded::LW;
+				d.rd=reg(ins[1]);
+				d.dest=1u<<d.rd;
+			}
+			else
+			{
+				//the stored register is forwarded to the MEM stage, without forwarding it has to be written back
+				op=Decoded::SW;
+				d.rt=reg(ins[1]);
+				if(!Policy::forwarding) d.sources|=1u<<d.rt;
+			}
+		}
+		else if(aluOp==8 || aluOp==9)
+		{
+			op=Decoded::BRANCH;
+			d.aluOp=aluOp;
+			d.rs=reg(ins[1]),d.rt=reg(ins[2]);
+			d.imm=address[ins[3]];
+			d.sources=1u<<d.rs|1u<<d.rt;
+		}
+		else if(Policy::jumps && aluOp==10)
+		{
+			op=Decoded::JUMP;
+			d.imm=address[ins[1]];
+		}
+		//set last, so that a command which threw while it was decoded is decoded again on the next visit
+		d.op=op;
+		return d;
+	}
+
+	//snapshot of the current state, cheap as no memory page is copied
+	Checkpoint checkpoint()
+	{
+		Checkpoint c;
+		std::copy(registers,registers+32,c.registers);
+		c.PCcurr=PCcurr;
+		c.PCnext=PCnext;
+		c.commandCount=commandCount;
+		c.data=data;
+		c.pipeline=pipeline;
+		c.caches=caches;
+		c.btb=btb;
+		c.predictor=copyPredictor(predictor);
+		c.predictorGeometry=savedGeometry(predictor);
+		return c;
+	}
+
+	//continue from the given snapshot, which stays valid and can be restored again
+	void restore(const Checkpoint &c)
+	{
+		std::copy(c.registers,c.registers+32,registers);
+		PCcurr=c.PCcurr;
+		PCnext=c.PCnext;
+		commandCount=c.commandCount;
+		data=c.data;
+		pipeline=c.pipeline;
+		caches=c.caches;
+		btb=c.btb;
+		predictor=copyPredictor(c.predictor);
+	}
+
+	//the copy and transfer of the predictor tables: a predictor policy has them, a predictor chosen at run time if it
+	//is a CheckpointablePredictor; null without a predictor or for one without them
+	static auto checkpointHooks(Predictor *p)
+	{
+		if constexpr(std::is_polymorphic<Predictor>::value) return dynamic_cast<CheckpointablePredictor*>(p);
+		else return p;
+	}
+
+	//the snapshots hold their own tables, so that the run does not change them and they can be restored again
+	static std::shared_ptr<Predictor> copyPredictor(const std::shared_ptr<Predictor> &p)
+	{
+		if(!p) return nullptr;
+		if constexpr(std::is_abstract<Predictor>::value)
+		{
+			auto *hooks=checkpointHooks(p.get());
+			return hooks ? hooks->clone() : p;
+		}
+		else return std::make_shared<Predictor>(*p);
+	}
+
+	//the geometry of the predictor in checkpoint files, 0 without one and UNSAVED_PREDICTOR for one without the hooks
+	static const uint64_t UNSAVED_PREDICTOR=~0ULL;
+	static uint64_t savedGeometry(const std::shared_ptr<Predictor> &p)
+	{
+		if(!p) return 0;
+		auto *hooks=checkpointHooks(p.get());
+		return hooks ? hooks->geometry() : UNSAVED_PREDICTOR;
+	}
+
+	//writes a snapshot of the current state to the file on a background thread once the previous write is done,
+	//the snapshot shares the memory pages so the simulation only waits for the copy of the tables
+	void saveCheckpoint(const std::string &fileName)
+	{
+		finishCheckpoint();
+		pendingCheckpoint.reset(new Checkpoint(checkpoint()));
+		checkpointThread=std::thread([this,fileName]()
+		{
+			CheckpointWriter writer(fileName,CHECKPOINT_VARIANT);
+			pendingCheckpoint->transfer(writer);
+			checkpointSaved=writer.commit();
+		});
+	}
+
+	//waits for the checkpoint being written, returns whether the last one was saved
+	bool finishCheckpoint()
+	{
+		if(checkpointThread.joinable()) checkpointThread.join();
+		pendingCheckpoint.reset();
+		return checkpointSaved;
+	}
+
+	//continue from a checkpoint file of the same program, false (and nothing changed) if it can not be used
+	bool loadCheckpoint(const std::string &fileName)
+	{
+		Checkpoint c;
+		//the file holds the state of the caches, the BTB and the predictor, which is only used with the configuration it was taken with
+		c.caches=caches;
+		c.btb=btb;
+		c.predictor=copyPredictor(predictor);
+		CheckpointReader reader(fileName,CHECKPOINT_VARIANT);
+		if(reader.ok) c.transfer(reader);
+		if(!reader.ok || c.commandCount.size()!=commands.size() ||
+		   c.pipeline.id_stage.entries.size()!=commands.size()+1 || !c.pipeline.id_stage.valid() ||
+		   !c.caches.sameGeometry(caches) || !c.btb.sameGeometry(btb) ||
+		   c.predictorGeometry!=savedGeometry(predictor) || c.predictorGeometry==UNSAVED_PREDICTOR) return false;
+		restore(c);
+		return true;
+	}
+
+	~PipelinedMIPS()
+	{
+		finishCheckpoint();
+	}
+
+	//runs the pipeline until the program ends (returns true) or stopCycle cycles have been executed (returns false),
+	//a stopped run is continued by calling it again
+	bool executeCommandPipelined(int stopCycle=-1)
+	{
+		//The logic of the below code is based on the Figure 4.51 of the book Computer Organization and Design Edition 5
+
+        int (&Tempregisters)[32] = pipeline.Tempregisters;
+		bool &HaltPC=pipeline.HaltPC;
+		int &PCSrc=pipeline.PCSrc;
+		//the words stored in a cycle are printed at its end
+		data.logWrites=true;
+
+		Latch *latch[6];
+		for(int i=0;i<6;i++) latch[i]=&pipeline.buffers[pipeline.slot[i]];
+		Latch *&idwb=latch[PipelineState::IDWB],*&aluwb=latch[PipelineState::ALUWB],*&memwb=latch[PipelineState::MEMWB];
+		Latch *&idmem=latch[PipelineState::IDMEM],*&alumem=latch[PipelineState::ALUMEM];
+		Latch *&idalu=latch[PipelineState::IDALU];
+		auto pass=[&](int next,int prev)
+		{
+			std::swap(latch[next],latch[prev]);
+			std::swap(pipeline.slot[next],pipeline.slot[prev]);
+		};
+
+		int &clockCycles=pipeline.clockCycles;
+
+		int &PCnew=pipeline.PCnew;
+
+		FetchQueue &id_stage=pipeline.id_stage;
+
+        int &stage_executed = pipeline.stage_executed;
+		int64_t &memoryReady=pipeline.memoryReady;
+		int64_t &fetchReady=pipeline.fetchReady;
+		int &fetchPC=pipeline.fetchPC;
+		vector<typename PipelineState::PendingLoad> &pendingLoads=pipeline.pendingLoads;
+		uint32_t &fillPending=pipeline.fillPending;
+		map<int,int> &MemoryWrite=pipeline.MemoryWrite;
+		int &FinalCount=pipeline.FinalCount;
+
+		//the value ID reads from register r
+		auto operand=[&](int r) { return Policy::forwarding ? Tempregisters[r] : registers[r]; };
+
+		while(true)
+		{
+			data.clearWrites();
+			int aluinput1=0,aluinput2=0;
+			int64_t loadReady=clockCycles;
+			//whether a miss held the MEM stage or the fetch this cycle
+			bool waiting=false;
+
+			//the fills arriving this cycle write the registers of their loads
+			if(Policy::forwarding && useCaches && caches.mshrs.capacity>0)
+			{
+				caches.tick(clockCycles);
+				for(size_t i=0;i<pendingLoads.size();)
+				{
+					pendingLoads[i].ready=caches.resolve(pendingLoads[i].address,pendingLoads[i].ready,clockCycles);
+					typename PipelineState::PendingLoad load=pendingLoads[i];
+					if(load.ready>clockCycles)
+					{
+						i++;
+						continue;
+					}
+					if(load.generation==pipeline.generation[load.reg]) registers[load.reg]=Tempregisters[load.reg]=load.value;
+					pendingLoads.erase(pendingLoads.begin()+i);
+				}
+				//a register stays pending while another load to it waits for its fill
+				fillPending=0;
+				for(auto &load : pendingLoads) fillPending|=1u<<load.reg;
+				if(!pendingLoads.empty()) stage_executed=2;
+			}
+
+			//THIS IS THE WB STAGE
+
+			if(memwb->WriteBack==1)
+			{
+				if(memwb->MemtoReg==1) 
+				{
+					registers[memwb->destregister]=memwb->memdata1;
+				}
+				else if(memwb->MemtoReg==0) 
+				{
+					registers[memwb->destregister]=memwb->memdata0;
+				}
+                stage_executed = 1;
+			}
+			ClearLatchValues(memwb);
+			/*************************************************************************************************************************/
+
+			//THIS IS THE MEM STAGE
+			//a data cache miss holds the access in the MEM stage, and the stages before it, until the line arrives
+			if(Policy::forwarding && useCaches && caches.mshrs.capacity>0 && (alumem->MemRead==1 || alumem->MemWrite==1))
+			{
+				//a store waits for the fill of the register it stores, a miss for a free MSHR
+				if(alumem->MemWrite==1 && (fillPending>>aluwb->destregister&1)) loadReady=-1;
+				else loadReady=caches.dataNonBlocking((uint32_t)alumem->aluresult*4,alumem->pc,clockCycles);
+				if(loadReady<0)
+				{
+					stage_executed=2;
+					waiting=true;
+					goto stalled;
+				}
+			}
+			else if(useCaches && (alumem->MemRead==1 || alumem->MemWrite==1))
+			{
+				if(memoryReady<0) memoryReady=caches.data((uint32_t)alumem->aluresult*4,alumem->pc,clockCycles);
+				memoryReady=caches.resolve((uint32_t)alumem->aluresult*4,memoryReady,clockCycles);
+				if(memoryReady>clockCycles)
+				{
+					stage_executed=2;
+					waiting=true;
+					goto stalled;
+				}
+				memoryReady=-1;
+			}
+			pass(PipelineState::MEMWB,PipelineState::ALUWB);
+
+			//Implementing the branch control unit
+			if(speculative() && alumem->TakeBranch!=2)
+			{
+				bool taken=alumem->TakeBranch==1;
+				if(predictor) predictor->update(alumem->pc,taken);
+				if(btb.enabled()) recordBranch(alumem->pc,taken,alumem->addresult);
+				pipeline.branches++;
+				if(taken!=(alumem->PredictTaken==1))
+				{
+					//squash the wrong path: the instruction decoded after the branch and the fetched ones
+					pipeline.mispredictions++;
+					if constexpr(Policy::memoryHazards)
+						if(idmem->MemWrite==1) MemoryWrite[(idalu->data1+idalu->offset)/4]=0;
+					ClearLatchValues(idalu);
+					ClearLatchValues(idmem);
+					ClearLatchValues(idwb);
+					id_stage.flush();
+					pipeline.removedJump=false;
+					PCnew=taken ? alumem->addresult : alumem->pc+1;
+					PCSrc=1;
+				}
+                stage_executed = 2;
+			}
+			else if(alumem->TakeBranch==1) 
+			{
+				PCnew=alumem->addresult;
+				PCSrc=1;
+				id_stage.flush();
+				HaltPC=false;
+                stage_executed = 2;
+			}
+			else if(alumem->TakeBranch==0)
+			{
+				PCSrc=0;
+				//hold the accumulated program counters until fetch
+				id_stage.hold();
+				HaltPC=false;
+                stage_executed = 2;
+			}
+
+
+			if(pipeline.removedJump)
+			{
+				btb.removed++;
+				pipeline.removedJump=false;
+			}
+
+			//passing the value of ALU/MEM latch to MEM/WB latch
+			if(alumem->ALUtoMem==1)
+			{
+				memwb->memdata0=alumem->aluresult;
+				memwb->WriteBack=1;
+				memwb->MemtoReg=0;
+                stage_executed = 2;
+			}
+
+			//if memory needs to be read
+			if(alumem->MemRead==1)
+			{
+				//so the memory which needs to be read, its address is the result of ALU
+				if(Policy::forwarding && loadReady>clockCycles)
+				{
+					pendingLoads.push_back({memwb->destregister,data.read(alumem->aluresult),(uint32_t)alumem->aluresult*4,loadReady,
+											++pipeline.generation[memwb->destregister]});
+					fillPending|=1u<<memwb->destregister;
+				}
+				else
+				{
+					memwb->memdata1=data.read(alumem->aluresult);
+					if constexpr(Policy::forwarding)
+					{
+						Tempregisters[memwb->destregister] = data.read(alumem->aluresult);
+						pipeline.generation[memwb->destregister]++;
+					}
+					memwb->WriteBack=1;
+					memwb->MemtoReg=1; // the data read from memory now needs 
+					//to be written back to register
+				}
+                stage_executed = 2;
+			}
+
+			if(alumem->MemWrite==1)
+			{
+				//so what needs to be read in MemWrite is stored
+				//in the register destregister 
+				memwb->WriteBack=0;
+				data[alumem->aluresult]=operand(memwb->destregister);
+				if constexpr(Policy::memoryHazards) MemoryWrite[alumem->aluresult]=0;
+                stage_executed = 2;
+			}
+
+			ClearLatchValues(alumem);
+
+			/************************************************************************************************************************/
+
+			//THIS IS THE ALU STAGE
+			//transferring the contents of idmem to alumem
+			pass(PipelineState::ALUMEM,PipelineState::IDMEM);
+			pass(PipelineState::ALUWB,PipelineState::IDWB);
+			//Implementing the MUX controlled by RegDst
+			if(idalu->RegDst==1) {
+                aluwb->destregister=idalu->destregister1;
+                stage_executed = 3;
+            }
+			else if(idalu->RegDst==0) {
+                aluwb->destregister=idalu->destregister0;
+                stage_executed = 3;
+            }
+			//Implementing the MUX controlled by ALUSrc
+            if (idalu->ALUOp != 0) {
+			    aluinput1=idalu->data1;
+                stage_executed = 3;
+            }
+			if(idalu->ALUSrc==1) {
+                aluinput2=idalu->offset;
+                stage_executed = 3;
+            }
+			else if(idalu->ALUSrc==0) {
+                aluinput2=idalu->data2;
+                stage_executed = 3;
+            }
+			//Implementing the ALU control unit
+			//ALU control unit takes input as ALUOp control signal
+			if(idalu->ALUOp<=4 && idalu->ALUOp>=1)
+			{
+				//so now the instruction is R type and we now check the value of rtype to get the actual instruction
+				if(idalu->ALUOp==1) alumem->aluresult=aluinput1+aluinput2;
+				else if(idalu->ALUOp==2) alumem->aluresult=aluinput1-aluinput2;
+				else if(idalu->ALUOp==3) alumem->aluresult=aluinput1*aluinput2;
+				else if(idalu->ALUOp==4)
+				{
+					if(aluinput1<aluinput2) alumem->aluresult=1;
+					else if(aluinput1>=aluinput2) alumem->aluresult=0;
+				}
+				alumem->ALUtoMem=1;
+                if (Policy::forwarding && ((idalu->RegDst == 0) || (idalu->RegDst == 1))) {
+                    Tempregisters[aluwb->destregister] = alumem->aluresult;
+                    pipeline.generation[aluwb->destregister]++;
+                }
+			}
+			else if(idalu->ALUOp==5)
+			{
+				alumem->aluresult=aluinput1+aluinput2;
+				alumem->ALUtoMem=1;
+                if (Policy::forwarding && ((idalu->RegDst == 0) || (idalu->RegDst == 1))) {
+                    Tempregisters[aluwb->destregister] = alumem->aluresult;
+                    pipeline.generation[aluwb->destregister]++;
+                }
+			}
+			else if(idalu->ALUOp==6)
+			{
+				alumem->aluresult=(uint32_t)(aluinput1+aluinput2)/4;
+			}
+			else if(idalu->ALUOp==7)
+			{
+				alumem->aluresult=(uint32_t)(aluinput1+aluinput2)/4;
+			}
+			else if(idalu->ALUOp==8)
+			{
+				alumem->addresult=idalu->destaddress;
+				if(aluinput1==aluinput2) alumem->TakeBranch=1;
+				else if(aluinput1!=aluinput2) alumem->TakeBranch=0;
+			}
+			else if(idalu->ALUOp==9)
+			{
+				alumem->addresult=idalu->destaddress;
+				if(aluinput1!=aluinput2) alumem->TakeBranch=1;
+				else if(aluinput1==aluinput2) alumem->TakeBranch=0;
+			}
+            else if (Policy::jumps && idalu->ALUOp == 10) {
+				PCnew=idalu->destaddress;
+				PCSrc=1;
+				id_stage.flush();
+            }
+
+			ClearLatchValues(idalu);
+
+			/*********************************************************************************************************************/
+
+			//THIS IS THE ID STAGE.
+
+            if (!id_stage.empty()) {
+                stage_executed = 4;
+            }
+
+			if((!id_stage.empty()) && (!HaltPC)) 
+			{
+				//scoreboard of the registers with a write ID has to wait for, out of the latches the instructions in flight
+				//left this cycle: without forwarding every write not written back yet, with it the lw which did not reach
+				//the MEM stage yet; either way the lw waiting for their fills
+				uint32_t busy=(Policy::forwarding ? alumem->loads : aluwb->writes|memwb->writes)|fillPending;
+				int counter_id_stage=id_stage.front();
+				const Decoded &d=decode(counter_id_stage);
+				//the comparator reads its operands at the start of the cycle, the ALU and a lw produce them at the end of it
+				if(Policy::forwarding && earlyBranches && d.op==Decoded::BRANCH)
+					busy|=aluwb->writes|(memwb->MemtoReg==1 ? memwb->writes : 0);
+				//the ID stage is stuck at the instruction while a register it reads is busy or the one it writes waits for a fill,
+				//which with a non-blocking cache is the case from the issue of the lw as its miss is only known in MEM
+				uint32_t filled=fillPending;
+				if(Policy::forwarding && useCaches && caches.mshrs.capacity>0) filled|=alumem->loads;
+				if(!(busy&d.sources) && !(filled&d.dest))
+				{
+					if(d.op==Decoded::ALU)
+					{
+						//R type instructions : add,sub,mul,slt
+						idalu->data1=operand(d.rs);
+						idalu->data2=operand(d.rt);
+						idalu->destregister1=d.rd;
+						idalu->RegDst=1;
+						idalu->ALUOp=d.aluOp;
+						idalu->ALUSrc=0;
+						idwb->writes=d.dest;
+						id_stage.pop();
+					}
+					else if(d.op==Decoded::ADDI)
+					{
+						idalu->offset=d.imm;
+						idalu->data1=operand(d.rs);
+						idalu->destregister0=d.rd;
+						idalu->RegDst=0;
+						idalu->ALUOp=5;
+						idalu->ALUSrc=1;
+						idwb->writes=d.dest;
+						id_stage.pop();
+					}
+					//with memoryHazards a lw also waits for the sw in flight to the word it reads
+					else if(d.op==Decoded::LW && (!Policy::memoryHazards || MemoryWrite[(operand(d.rs)+d.imm)/4]==0))
+					{
+						idalu->offset=d.imm;
+						idalu->data1=operand(d.rs);
+						idalu->destregister0=d.rd;
+						idalu->RegDst=0;
+						idalu->ALUOp=6;
+						idalu->ALUSrc=1;
+						idmem->MemRead=1;
+						idmem->pc=counter_id_stage;
+						idwb->writes=idmem->loads=d.dest;
+						id_stage.pop();
+					}
+					else if(d.op==Decoded::SW)
+					{
+						idalu->offset=d.imm;
+						idalu->data1=operand(d.rs);
+						idalu->destregister0=d.rt;
+						idalu->RegDst=0;
+						idalu->ALUOp=7;
+						idalu->ALUSrc=1;
+						idmem->MemWrite=1;
+						idmem->pc=counter_id_stage;
+						if constexpr(Policy::memoryHazards) MemoryWrite[(idalu->data1+d.imm)/4]=1;
+						id_stage.pop();
+					}
+					else if(d.op==Decoded::BRANCH && earlyBranches)
+					{
+						//the fetched instructions follow the predicted direction, or the next command without a predictor
+						bool taken=(d.aluOp==8)==(operand(d.rs)==operand(d.rt));
+						bool predictedTaken=id_stage.frontTaken();
+						pipeline.branches++;
+						if(taken) pipeline.takenBranches++;
+						if(predictor) predictor->update(counter_id_stage,taken);
+						if(btb.enabled()) recordBranch(counter_id_stage,taken,d.imm);
+						if(speculative() && taken!=predictedTaken) pipeline.mispredictions++;
+						id_stage.pop();
+						if(taken!=predictedTaken)
+						{
+							id_stage.flush();
+							PCnew=taken ? d.imm : counter_id_stage+1;
+							PCSrc=1;
+						}
+					}
+					else if(d.op==Decoded::BRANCH)
+					{
+						idalu->destaddress=d.imm;
+						idalu->data1=operand(d.rs);
+						idalu->data2=operand(d.rt);
+						if(speculative())
+						{
+							idmem->pc=counter_id_stage;
+							idmem->PredictTaken=id_stage.frontTaken();
+						}
+						else HaltPC=true;
+						idalu->ALUOp=d.aluOp;
+						idalu->ALUSrc=0;
+						id_stage.pop();
+					}
+					else if(d.op==Decoded::JUMP)
+					{
+						//a j fetch already followed leaves the stages after ID idle
+						if(btb.enabled()) btb.insert(counter_id_stage,d.imm);
+						if(btb.enabled() && id_stage.frontTaken()) pipeline.removedJump=true;
+						else
+						{
+							idalu->destaddress=d.imm;
+							idalu->ALUOp=10;
+						}
+						id_stage.pop();
+					}
+				}
+				else if(earlyBranches && d.op==Decoded::BRANCH) pipeline.branchStalls++;
+			}
+			/**************************************************************************************************************************/
+
+			//THIS IS THE IF STAGE.
+
+			//deciding the address of the next instruction to be executed
+			//a redirect also replaces the next pc, which a fetch down the other path may have set
+			if(PCSrc==1) 
+			{
+				PCcurr=PCnext=PCnew;
+			}
+			else if(PCSrc==0)
+			{
+				PCcurr=PCnext;
+				id_stage.replay();
+			}
+			else if (Policy::jumps ? (PCSrc==2 && PCnext == PCcurr+1) || PCnext == 0 : PCSrc==2) PCcurr=PCnext;
+
+			//an instruction cache miss holds the fetch until the line arrives
+			if(useCaches && PCcurr<(int)commands.size() && fetchPC!=PCcurr)
+			{
+				fetchPC=PCcurr;
+				fetchReady=caches.instruction(4*PCcurr,clockCycles);
+			}
+			if(useCaches) fetchReady=caches.resolve(4*fetchPC,fetchReady,clockCycles);
+			if(useCaches && fetchReady>clockCycles)
+			{
+                stage_executed = 5;
+				waiting=true;
+			}
+			else if(PCcurr<(int)commands.size() && !id_stage.full())
+			{
+				int target=speculative() ? predictTarget(PCcurr) : -1;
+				id_stage.push(PCcurr,target>=0);
+				PCnext=PCcurr+1;
+				fetchPC=-1;
+				//a j or a branch predicted taken is followed by its target
+				if(target>=0) PCcurr=PCnext=target;
+                stage_executed = 5;
+			}
+		stalled:
+			PCSrc=2;
+
+			clockCycles++;
+
+			//outputting values
+			printRegisters(clockCycles);
+
+			cout<<(int)data.writes.size()<<" ";
+			for(uint32_t i : data.writes) cout<<i<<" "<<data.read(i)<<" ";
+			cout<<"\n";
+
+			if constexpr(Policy::idleTermination)
+			{
+				stage_executed--;
+				if (!stage_executed) break;
+			}
+			else
+			{
+				//the queue also runs empty behind a branch at the end of the program, a squash or a miss, so only
+				//consecutive cycles count and none in which a miss held the pipeline
+				if(FinalCount==3) break;
+				if(id_stage.empty() && !waiting) FinalCount++;
+				else FinalCount=0;
+			}
+            if (checkpointInterval && clockCycles % checkpointInterval == 0) saveCheckpoint(checkpointFile);
+            if (clockCycles == stopCycle) return false;
+		}
+		finishCheckpoint();
+		if(useCaches) caches.report(cout);
+		if(btb.enabled()) btb.report(cout);
+		if(speculative())
+		{
+			cout<<"Branch prediction: "<<pipeline.branches<<" branches, "<<pipeline.mispredictions<<" mispredicted, accuracy "<<fixed<<setprecision(2)
+				<<(pipeline.branches==0 ? 0 : 100.0*(pipeline.branches-pipeline.mispredictions)/pipeline.branches)<<"%\n"<<defaultfloat;
+		}
+		if(earlyBranches)
+		{
+			cout<<"Early branch resolution: "<<pipeline.branches<<" branches, "<<pipeline.takenBranches<<" taken, "
+				<<pipeline.branchStalls<<" cycles stalled for the comparator operands\n";
+		}
+		return true;
+	}
+
+	// print the register data in hexadecimal
+	void printRegisters(int clockCycle)
+	{
+		if constexpr(Policy::cycleHeader)
+			std::cout << "Cycle number: " << clockCycle << '\n'
+					  << std::hex;
+		for (int i = 0; i < 32; ++i)
+			std::cout << registers[i] << ' ';
+		std::cout << std::dec << '\n';
+	}
+};
+
+#endif
@@ -0,0 +1,217 @@
+/**
+ * @file Prefetcher.hpp
+ * data prefetchers trained on the lw/sw of the pipelined simulators
+ */
+
+#ifndef __PREFETCHER_HPP__
+#define __PREFETCHER_HPP__
+
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+/*
+	every prefetcher observes the demand access of the lw/sw at pc to the byte address with access and appends
+	the byte addresses to prefetch; transfer lists its configuration and its tables for the checkpoints
+*/
+
+// prefetch the next degree lines after every miss
+struct NextLinePrefetcher
+{
+	int lineSize, degree;
+
+	NextLinePrefetcher(int lineSize = 64, int degree = 1) : lineSize(lineSize), degree(degree) {}
+
+	bool sameConfig(const NextLinePrefetcher &other) const
+	{
+		return lineSize == other.lineSize && degree == other.degree;
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(lineSize), a.field(degree);
+	}
+
+	void access(uint32_t /*pc*/, uint32_t address, bool hit, std::vector<uint32_t> &prefetches)
+	{
+		if (hit)
+			return;
+		for (int i = 1; i <= degree; ++i)
+			prefetches.push_back(address + i * lineSize);
+	}
+};
+
+/*
+	table of the last address and stride of every lw/sw, indexed by its PC: once the same stride
+	was seen twice in a row, the next degree addresses along it are prefetched
+*/
+struct StridePrefetcher
+{
+	struct Entry
+	{
+		uint32_t pc = ~0u, last = 0;
+		int stride = 0, confidence = 0;
+	};
+	std::vector<Entry> table;
+	int degree;
+
+	StridePrefetcher(int entries = 64, int degree = 2) : table(entries), degree(degree) {}
+
+	bool sameConfig(const StridePrefetcher &other) const
+	{
+		return table.size() == other.table.size() && degree == other.degree;
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(table);
+		a.field(degree);
+	}
+
+	void access(uint32_t pc, uint32_t address, bool /*hit*/, std::vector<uint32_t> &prefetches)
+	{
+		Entry &entry = table[pc % table.size()];
+		if (entry.pc != pc)
+		{
+			entry = Entry();
+			entry.pc = pc, entry.last = address;
+			return;
+		}
+		int stride = address - entry.last;
+		if (stride == entry.stride)
+		{
+			if (entry.confidence < 3)
+				++entry.confidence;
+		}
+		else if (entry.confidence > 0)
+			--entry.confidence;
+		else
+			entry.stride = stride;
+		entry.last = address;
+		if (entry.confidence >= 2 && entry.stride != 0)
+			for (int i = 1; i <= degree; ++i)
+				prefetches.push_back(address + i * entry.stride);
+	}
+};
+
+/*
+	stream buffers following ascending runs of missing lines: a miss inside the window of a stream
+	advances it and keeps depth lines prefetched ahead of the miss, any other miss restarts the
+	least recently used stream behind it
+*/
+struct StreamBufferPrefetcher
+{
+	struct Stream
+	{
+		uint32_t next = 0, end = 0;
+		uint64_t used = 0;
+	};
+	std::vector<Stream> streams;
+	int lineSize, depth;
+	uint64_t time = 0;
+
+	StreamBufferPrefetcher(int lineSize = 64, int streams = 4, int depth = 4) : streams(streams), lineSize(lineSize), depth(depth) {}
+
+	bool sameConfig(const StreamBufferPrefetcher &other) const
+	{
+		return streams.size() == other.streams.size() && lineSize == other.lineSize && depth == other.depth;
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		a.field(streams);
+		a.field(lineSize), a.field(depth);
+		a.field(time);
+	}
+
+	void access(uint32_t /*pc*/, uint32_t address, bool hit, std::vector<uint32_t> &prefetches)
+	{
+		if (hit)
+			return;
+		uint32_t line = address / lineSize;
+		Stream *stream = &streams[0];
+		for (Stream &s : streams)
+		{
+			if (s.used != 0 && line >= s.next && line < s.end)
+			{
+				stream = &s;
+				break;
+			}
+			if (s.used < stream->used)
+				stream = &s;
+		}
+		if (!(stream->used != 0 && line >= stream->next && line < stream->end))
+			stream->end = line + 1;
+		stream->next = line + 1;
+		stream->used = ++time;
+		for (; stream->end < line + 1 + depth; ++stream->end)
+			prefetches.push_back(stream->end * lineSize);
+	}
+};
+
+struct NoPrefetcher
+{
+	void access(uint32_t, uint32_t, bool, std::vector<uint32_t> &) {}
+	bool sameConfig(const NoPrefetcher &) const { return true; }
+	template <typename Archive>
+	void transfer(Archive &) {}
+};
+
+/*
+	the data prefetcher of the cache hierarchy, one of the models held by value: a copy of the hierarchy
+	has its own tables, and a checkpoint holds the model, its configuration and its tables
+*/
+struct DataPrefetcher
+{
+	std::variant<NoPrefetcher, NextLinePrefetcher, StridePrefetcher, StreamBufferPrefetcher> model;
+
+	DataPrefetcher() = default;
+	template <typename Model>
+	DataPrefetcher(const Model &model) : model(model) {}
+
+	explicit operator bool() const
+	{
+		return model.index() != 0;
+	}
+
+	void access(uint32_t pc, uint32_t address, bool hit, std::vector<uint32_t> &prefetches)
+	{
+		std::visit([&](auto &prefetcher)
+				   { prefetcher.access(pc, address, hit, prefetches); },
+				   model);
+	}
+
+	bool sameConfig(const DataPrefetcher &other) const
+	{
+		return model.index() == other.model.index() && std::visit([&](auto &prefetcher)
+																	{ return prefetcher.sameConfig(std::get<std::decay_t<decltype(prefetcher)>>(other.model)); },
+																	model);
+	}
+
+	template <typename Archive>
+	void transfer(Archive &a)
+	{
+		uint32_t kind = model.index();
+		a.field(kind);
+		if (kind != model.index())
+		{
+			// a checkpoint of another model is read into one of its kind, which sameConfig rejects
+			if (kind == 1)
+				model = NextLinePrefetcher();
+			else if (kind == 2)
+				model = StridePrefetcher();
+			else if (kind == 3)
+				model = StreamBufferPrefetcher();
+			else
+				model = NoPrefetcher();
+		}
+		std::visit([&](auto &prefetcher)
+				   { prefetcher.transfer(a); },
+				   model);
+	}
+};
+
+#endif
@@ -0,0 +1,13 @@
+# loop kernel used by benchmark.cpp, the loop body runs 2000000 times
+	addi $s0, $0, 1000
+	addi $t1, $0, 2000000
+loop:
+	addi $s2, $s0, 4
+	lw $t2, 0($s2)
+	add $s1, $s1, $t2
+	addi $t2, $t2, 3
+	sw $t2, 0($s2)
+	addi $t0, $t0, 1
+	slt $t3, $t0, $t1
+	bne $t3, $0, loop
+	sw $s1, 0($s0)
@@ -0,0 +1,61 @@
+#include "MIPS_Processor.hpp"
+#include <chrono>
+
+// discards everything written to it, used to silence the simulator output while timing
+struct NullBuffer : std::streambuf
+{
+	int overflow(int c) { return c; }
+};
+
+// run the program once with the given engine and return the time taken in seconds
+double run(const char *fileName, const std::string &engine, long long &executed)
+{
+	std::ifstream file(fileName);
+	MIPS_Architecture *mips = new MIPS_Architecture(file);
+	mips->printCycles = false;
+	mips->useFusion = engine == "fused";
+
+	NullBuffer null;
+	std::streambuf *out = std::cout.rdbuf(&null);
+	auto start = std::chrono::steady_clock::now();
+	if (engine == "jit")
+		mips->executeCommandsJIT();
+	else if (engine != "switch")
+		mips->executeCommandsThreaded();
+	else
+		mips->executeCommandsUnpipelined();
+	auto end = std::chrono::steady_clock::now();
+	std::cout.rdbuf(out);
+
+	executed = 0;
+	for (int count : mips->commandCount)
+		executed += count;
+	delete mips;
+	return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2 && argc != 3)
+	{
+		std::cerr << "Required argument: file_name\n./benchmark <file name> [repetitions]\n";
+		return 0;
+	}
+	if (!std::ifstream(argv[1]).is_open())
+	{
+		std::cerr << "File could not be opened. Terminating...\n";
+		return 0;
+	}
+	int repetitions = argc == 3 ? std::stoi(argv[2]) : 5;
+
+	for (std::string engine : {"switch", "threaded", "fused", "jit"})
+	{
+		double best = 1e18;
+		long long executed = 0;
+		for (int i = 0; i < repetitions; ++i)
+			best = std::min(best, run(argv[1], engine, executed));
+		std::cout << engine << ":\t" << executed << " instructions in " << best << " s, "
+				  << executed / best / 1e6 << " million instructions per second\n";
+	}
+	return 0;
+}
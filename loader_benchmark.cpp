@@ -0,0 +1,80 @@
+#include "MIPS_Processor.hpp"
+#include <chrono>
+
+// write a generated program with the given number of lines: labelled blocks of arithmetic, memory and branch commands
+void generate(const std::string &fileName, int lines)
+{
+	std::ofstream out(fileName);
+	const char *registers[] = {"$t0", "$t1", "$t2", "$t3", "$s0", "$s1", "$s2", "$s3"};
+	for (int i = 0; i < lines; ++i)
+	{
+		const char *rd = registers[i % 8], *rs = registers[(i / 8) % 8], *rt = registers[(i / 64) % 8];
+		switch (i % 8)
+		{
+		case 0:
+			out << "block" << i << ":\n";
+			break;
+		case 1:
+			out << "\taddi " << rd << ", " << rs << ", " << i % 1000 << "\t# step\n";
+			break;
+		case 2:
+			out << "\tadd " << rd << ", " << rs << ", " << rt << '\n';
+			break;
+		case 3:
+			out << "\tlw " << rd << ", " << 4 * (i % 256) << '(' << rs << ")\n";
+			break;
+		case 4:
+			out << "\tsw " << rd << ", " << 4 * (i % 256) << '(' << rs << ")\n";
+			break;
+		case 5:
+			out << "\tslt " << rd << ", " << rs << ", " << rt << '\n';
+			break;
+		case 6:
+			out << "\tbne " << rd << ", " << rs << ", block" << i - 6 << '\n';
+			break;
+		default:
+			out << "\tmul " << rd << ", " << rs << ", " << rt << '\n';
+			break;
+		}
+	}
+}
+
+// time constructing a simulator with the given loader, in seconds
+template <typename Loader>
+double measure(Loader load)
+{
+	auto start = std::chrono::steady_clock::now();
+	MIPS_Architecture *mips = load();
+	auto end = std::chrono::steady_clock::now();
+	delete mips;
+	return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+	int lines = argc >= 2 ? std::stoi(argv[1]) : 4000000;
+	std::string fileName = "loader_benchmark.asm", imageName = "loader_benchmark.img";
+	generate(fileName, lines);
+	std::remove(imageName.c_str());
+
+	std::cout << lines << " lines\n";
+	std::cout << "stream:\t" << measure([&]()
+									   { std::ifstream file(fileName); return new MIPS_Architecture(file); })
+			  << " s\n";
+	for (int threads : {1, 0})
+	{
+		MIPS_Architecture::loaderThreads = threads;
+		std::cout << "mapped (" << (threads ? "1 thread" : "all threads") << "):\t" << measure([&]()
+																						 { return new MIPS_Architecture(fileName); })
+				  << " s\n";
+	}
+	std::cout << "image (write):\t" << measure([&]()
+											  { return new MIPS_Architecture(fileName, imageName); })
+			  << " s\n";
+	std::cout << "image (read):\t" << measure([&]()
+											 { return new MIPS_Architecture(fileName, imageName); })
+			  << " s\n";
+	std::remove(fileName.c_str());
+	std::remove(imageName.c_str());
+	return 0;
+}
@@ -0,0 +1,454 @@
+#include "Pipeline.hpp"
+// the variants share their include guard and the name of their simulator, so each is read into its own namespace
+namespace part1
+{
+#include "final_part1.hpp"
+}
+#undef __MIPS_PROCESSOR_HPP__
+namespace work
+{
+#include "work.hpp"
+}
+#undef __MIPS_PROCESSOR_HPP__
+#include "final_part2.hpp"
+#include <cstdio>
+#include <functional>
+#include <sstream>
+
+// discards everything written to it, used to silence the simulator output
+struct NullBuffer : std::streambuf
+{
+	int overflow(int c) { return c; }
+};
+
+// registers and non-zero data words a run ends with
+struct FinalState
+{
+	std::vector<int> registers;
+	std::map<uint32_t, int> data;
+	int cycles;
+
+	bool operator==(const FinalState &other) const
+	{
+		return registers == other.registers && data == other.data;
+	}
+};
+
+int failures = 0;
+
+void check(bool condition, const std::string &name)
+{
+	std::cout << (condition ? "PASS " : "FAIL ") << name << '\n';
+	failures += !condition;
+}
+
+std::string writeProgram(const std::string &text)
+{
+	std::string fileName = "pipeline_test.asm";
+	std::ofstream(fileName) << text;
+	return fileName;
+}
+
+template <typename Simulator>
+FinalState finalState(Simulator &mips)
+{
+	FinalState state;
+	state.registers.assign(mips.registers, mips.registers + 32);
+	mips.data.forEachNonZero([&](uint32_t i, int value)
+							 { state.data[i] = value; });
+	state.cycles = mips.pipeline.clockCycles;
+	return state;
+}
+
+// run the program to its end on the variant Simulator with the configuration applied by setup
+template <typename Simulator = MIPS_Architecture, typename Setup>
+FinalState run(const std::string &program, Setup setup)
+{
+	std::ifstream file(writeProgram(program));
+	Simulator mips(file);
+	setup(mips);
+	NullBuffer null;
+	std::streambuf *out = std::cout.rdbuf(&null);
+	mips.executeCommandPipelined();
+	std::cout.rdbuf(out);
+	return finalState(mips);
+}
+
+auto blockingCaches = [](auto &mips)
+{
+	mips.useCaches = true;
+};
+
+auto nonBlockingCaches = [](auto &mips)
+{
+	mips.useCaches = true;
+	mips.caches.mshrs.capacity = 4;
+};
+
+// a younger write to the register of a missing lw is not overwritten by the late fill
+void testMissFillOrder()
+{
+	std::string program = "addi $s0, $0, 2000\nlw $t0, 0($s0)\nadd $t0, $s0, $s0\naddi $t5, $t0, 1\nsw $t5, 4($s0)\n";
+	FinalState plain = run(program, [](MIPS_Architecture &) {});
+	FinalState blocking = run(program, blockingCaches);
+	FinalState nonBlocking = run(program, nonBlockingCaches);
+	check(plain.registers[8] == 4000 && plain.registers[13] == 4001 && plain.data[501] == 4001, "miss fill order: expected result without caches");
+	check(blocking == plain, "miss fill order: blocking caches");
+	check(nonBlocking == plain, "miss fill order: non-blocking caches");
+}
+
+// a loop of loads, stores and dependent arithmetic ends the same with and without MSHRs
+void testNonBlockingMatchesBlocking()
+{
+	std::string program =
+		"addi $s0, $0, 4000\naddi $t1, $0, 64\n"
+		"fill:\nsw $t1, 0($s0)\naddi $s0, $s0, 256\naddi $t1, $t1, -1\nbne $t1, $0, fill\n"
+		"addi $s0, $0, 4000\naddi $t1, $0, 64\n"
+		"sum:\nlw $t0, 0($s0)\nadd $t0, $t0, $t1\nlw $t2, 256($s0)\nadd $s1, $s1, $t0\nadd $t2, $t2, $s1\n"
+		"sw $t2, 128($s0)\naddi $s0, $s0, 256\naddi $t1, $t1, -1\nbne $t1, $0, sum\n";
+	FinalState plain = run(program, [](MIPS_Architecture &) {});
+	FinalState blocking = run(program, blockingCaches);
+	FinalState nonBlocking = run(program, nonBlockingCaches);
+	check(blocking == plain, "load loop: blocking caches");
+	check(nonBlocking == plain, "load loop: non-blocking caches");
+}
+
+// a counted loop ending in its branch, so that fetch runs past the end of the program on a not taken prediction
+const std::string countedLoop =
+	"addi $s0, $0, 1000\naddi $t1, $0, 60\n"
+	"loop:\naddi $t0, $t0, 1\nadd $s1, $s1, $t0\nsw $s1, 0($s0)\nbne $t0, $t1, loop\n";
+
+// the variant ending on an empty decode queue runs the loop to its end with and without a predictor
+void testWorkTermination()
+{
+	FinalState plain = run<work::MIPS_Architecture>(countedLoop, [](auto &) {});
+	check(plain.registers[8] == 60 && plain.data[250] == 1830, "work termination: loop ending in its branch");
+	check(run<work::MIPS_Architecture>(countedLoop, [](auto &mips)
+									   { mips.predictor = std::make_shared<SaturatingBranchPredictor>(0); }) == plain,
+		  "work termination: saturating predictor");
+	check(run<work::MIPS_Architecture>(countedLoop, [](auto &mips)
+									   { mips.predictor = std::make_shared<BHRBranchPredictor>(0); }) == plain,
+		  "work termination: history predictor");
+	check(run<work::MIPS_Architecture>(countedLoop, [](auto &mips)
+									   { mips.predictor = std::make_shared<SaturatingBranchPredictor>(0), mips.btb.configure(16, 2); }) == plain,
+		  "work termination: predictor and BTB");
+}
+
+// the same variant does not take the cycles a miss holds the empty decode queue for as the end of the program
+void testWorkCaches()
+{
+	std::string loads =
+		"addi $s0, $0, 4000\naddi $t1, $0, 16\n"
+		"loop:\nlw $t0, 0($s0)\nadd $s1, $s1, $t0\nsw $s1, 512($s0)\naddi $s0, $s0, 256\naddi $t1, $t1, -1\nbne $t1, $0, loop\n"
+		"sw $s1, 0($0)\n";
+	check(run<work::MIPS_Architecture>(countedLoop, blockingCaches) == run<work::MIPS_Architecture>(countedLoop, [](auto &) {}),
+		  "work caches: counted loop");
+	FinalState plain = run<work::MIPS_Architecture>(loads, [](auto &) {});
+	FinalState cached = run<work::MIPS_Architecture>(loads, blockingCaches);
+	check(cached == plain && cached.cycles > plain.cycles, "work caches: loads and stores");
+}
+
+// the trace and the statistics of a run stopped after stopCycle cycles, checkpointed to a file and resumed by another simulator
+template <typename Setup>
+bool resumedRunMatches(const std::string &program, Setup setup, int stopCycle)
+{
+	std::ostringstream full, resumed;
+	std::streambuf *out = std::cout.rdbuf(full.rdbuf());
+	{
+		std::ifstream file(writeProgram(program));
+		MIPS_Architecture mips(file);
+		setup(mips);
+		mips.executeCommandPipelined();
+	}
+	std::cout.rdbuf(resumed.rdbuf());
+	{
+		std::ifstream file(writeProgram(program));
+		MIPS_Architecture mips(file);
+		setup(mips);
+		mips.executeCommandPipelined(stopCycle);
+		mips.saveCheckpoint("pipeline_test.ckpt");
+		mips.finishCheckpoint();
+	}
+	bool loaded;
+	{
+		std::ifstream file(writeProgram(program));
+		MIPS_Architecture mips(file);
+		setup(mips);
+		loaded = mips.loadCheckpoint("pipeline_test.ckpt");
+		mips.executeCommandPipelined();
+	}
+	std::cout.rdbuf(out);
+	remove("pipeline_test.ckpt");
+	return loaded && full.str() == resumed.str();
+}
+
+// a loop reading one word of every other line, which the stride and stream prefetchers learn
+const std::string stridedLoop =
+	"addi $s0, $0, 8000\naddi $t1, $0, 200\n"
+	"loop:\nlw $t0, 0($s0)\nadd $s1, $s1, $t0\nsw $s1, 64($s0)\naddi $s0, $s0, 128\naddi $t1, $t1, -1\nbne $t1, $0, loop\n";
+
+// the prefetcher tables are part of the checkpoint
+void testCheckpointPrefetchers()
+{
+	check(resumedRunMatches(stridedLoop, [](MIPS_Architecture &mips)
+							{ blockingCaches(mips), mips.caches.prefetcher = StridePrefetcher(); }, 700),
+		  "checkpoint prefetcher: stride");
+	check(resumedRunMatches(stridedLoop, [](MIPS_Architecture &mips)
+							{ nonBlockingCaches(mips), mips.caches.prefetcher = StreamBufferPrefetcher(); }, 700),
+		  "checkpoint prefetcher: stream buffers");
+}
+
+// a loop whose inner branch alternates, so that the predictor tables differ from their initial state at every cycle
+const std::string alternatingLoop =
+	"addi $t1, $0, 120\n"
+	"loop:\naddi $t2, $t2, 1\nslt $t3, $t2, $t1\nbeq $t4, $0, skip\nadd $s1, $s1, $t2\nskip:\nsub $t4, $0, $t4\naddi $t4, $t4, 1\n"
+	"addi $t4, $t4, -1\nbne $t3, $0, loop\n";
+
+void saturatingPredictor(MIPS_Architecture &mips)
+{
+	mips.predictor = std::make_shared<SaturatingBranchPredictor>(1);
+}
+
+void bhrPredictor(MIPS_Architecture &mips)
+{
+	mips.predictor = std::make_shared<SaturatingBHRBranchPredictor>(1, 1 << 16);
+}
+
+// the predictor tables are part of the checkpoint, on disk and in memory
+void testCheckpointPredictor()
+{
+	check(resumedRunMatches(alternatingLoop, saturatingPredictor, 300), "checkpoint predictor: saturating");
+	check(resumedRunMatches(alternatingLoop, bhrPredictor, 300), "checkpoint predictor: per-pc history");
+	std::ostringstream first, second;
+	std::streambuf *out = std::cout.rdbuf(first.rdbuf());
+	{
+		std::ifstream file(writeProgram(alternatingLoop));
+		MIPS_Architecture mips(file);
+		bhrPredictor(mips);
+		mips.executeCommandPipelined(300);
+		auto snapshot = mips.checkpoint();
+		mips.executeCommandPipelined();
+		std::cout.rdbuf(second.rdbuf());
+		mips.restore(snapshot);
+		mips.executeCommandPipelined();
+	}
+	std::cout.rdbuf(out);
+	std::string full = first.str();
+	check(full.substr(full.size() - second.str().size()) == second.str(), "checkpoint predictor: restored in memory");
+
+	{
+		std::ifstream file(writeProgram(alternatingLoop));
+		MIPS_Architecture mips(file);
+		saturatingPredictor(mips);
+		NullBuffer null;
+		out = std::cout.rdbuf(&null);
+		mips.executeCommandPipelined(300);
+		std::cout.rdbuf(out);
+		mips.saveCheckpoint("pipeline_test.ckpt");
+		mips.finishCheckpoint();
+	}
+	auto resumes = [&](auto setup)
+	{
+		std::ifstream file(writeProgram(alternatingLoop));
+		MIPS_Architecture mips(file);
+		setup(mips);
+		return mips.loadCheckpoint("pipeline_test.ckpt");
+	};
+	check(!resumes([](MIPS_Architecture &) {}), "checkpoint predictor: rejected without a predictor");
+	check(!resumes(bhrPredictor), "checkpoint predictor: rejected by another predictor");
+	remove("pipeline_test.ckpt");
+}
+
+// a predictor of a user, with nothing but predict and update
+struct AlwaysTaken : BranchPredictor
+{
+	bool predict(uint32_t) { return true; }
+	void update(uint32_t, bool) {}
+};
+
+// such a predictor runs and is snapshotted, but a checkpoint file cannot hold its state and is not resumed
+void testUserPredictor()
+{
+	auto alwaysTaken = [](auto &mips)
+	{ mips.predictor = std::make_shared<AlwaysTaken>(); };
+	check(run(alternatingLoop, alwaysTaken) == run(alternatingLoop, [](auto &) {}), "user predictor: same result");
+	{
+		std::ifstream file(writeProgram(alternatingLoop));
+		MIPS_Architecture mips(file);
+		alwaysTaken(mips);
+		NullBuffer null;
+		std::streambuf *out = std::cout.rdbuf(&null);
+		mips.executeCommandPipelined(100);
+		mips.restore(mips.checkpoint());
+		mips.executeCommandPipelined();
+		std::cout.rdbuf(out);
+		check(finalState(mips) == run(alternatingLoop, [](auto &) {}), "user predictor: restored in memory");
+		mips.saveCheckpoint("pipeline_test.ckpt");
+		mips.finishCheckpoint();
+	}
+	std::ifstream file(writeProgram(alternatingLoop));
+	MIPS_Architecture mips(file);
+	alwaysTaken(mips);
+	check(!mips.loadCheckpoint("pipeline_test.ckpt"), "user predictor: checkpoint file not resumed");
+	remove("pipeline_test.ckpt");
+}
+
+// a checkpoint is only resumed with the cache configuration it was taken with
+void testCheckpointCacheGeometry()
+{
+	std::string program = "addi $s0, $0, 4000\naddi $t1, $0, 64\nloop:\nsw $t1, 0($s0)\naddi $s0, $s0, 256\naddi $t1, $t1, -1\nbne $t1, $0, loop\n";
+	{
+		std::ifstream file(writeProgram(program));
+		MIPS_Architecture mips(file);
+		nonBlockingCaches(mips);
+		NullBuffer null;
+		std::streambuf *out = std::cout.rdbuf(&null);
+		mips.executeCommandPipelined(50);
+		std::cout.rdbuf(out);
+		mips.saveCheckpoint("pipeline_test.ckpt");
+		mips.finishCheckpoint();
+	}
+	auto resumes = [&](auto setup)
+	{
+		std::ifstream file(writeProgram(program));
+		MIPS_Architecture mips(file);
+		setup(mips);
+		return mips.loadCheckpoint("pipeline_test.ckpt");
+	};
+	check(resumes(nonBlockingCaches), "checkpoint geometry: same configuration");
+	check(!resumes([](MIPS_Architecture &mips)
+				   { nonBlockingCaches(mips), mips.caches = CacheHierarchy({1 << 15, 4, 64, 1, LRU}), mips.caches.mshrs.capacity = 4; }),
+		  "checkpoint geometry: other associativity");
+	check(!resumes([](MIPS_Architecture &mips)
+				   { nonBlockingCaches(mips), mips.caches = CacheHierarchy(CacheConfig(), {1 << 15, 16, 32, 1, LRU}), mips.caches.mshrs.capacity = 4; }),
+		  "checkpoint geometry: other line size");
+	check(!resumes(blockingCaches), "checkpoint geometry: other MSHR capacity");
+	check(!resumes([](MIPS_Architecture &mips)
+				   { nonBlockingCaches(mips), mips.caches.prefetcher = StridePrefetcher(); }),
+		  "checkpoint geometry: other prefetcher");
+	check(!resumes([](MIPS_Architecture &mips)
+				   { nonBlockingCaches(mips), mips.caches.memoryLatency = 150; }),
+		  "checkpoint geometry: other memory latency");
+	check(!resumes([](MIPS_Architecture &mips)
+				   { nonBlockingCaches(mips), mips.caches.useDram = true; }),
+		  "checkpoint geometry: with DRAM");
+	remove("pipeline_test.ckpt");
+}
+
+// the state of the DRAM controller is part of the checkpoint, which is only resumed with the same DRAM configuration
+void testCheckpointDram()
+{
+	auto dram = [](MIPS_Architecture &mips)
+	{ nonBlockingCaches(mips), mips.caches.useDram = true; };
+	check(resumedRunMatches(stridedLoop, dram, 700), "checkpoint DRAM: resumed");
+	{
+		std::ifstream file(writeProgram(stridedLoop));
+		MIPS_Architecture mips(file);
+		dram(mips);
+		NullBuffer null;
+		std::streambuf *out = std::cout.rdbuf(&null);
+		mips.executeCommandPipelined(300);
+		std::cout.rdbuf(out);
+		mips.saveCheckpoint("pipeline_test.ckpt");
+		mips.finishCheckpoint();
+	}
+	auto resumes = [&](auto setup)
+	{
+		std::ifstream file(writeProgram(stridedLoop));
+		MIPS_Architecture mips(file);
+		setup(mips);
+		return mips.loadCheckpoint("pipeline_test.ckpt");
+	};
+	check(!resumes(nonBlockingCaches), "checkpoint DRAM: rejected without DRAM");
+	check(!resumes([&](MIPS_Architecture &mips)
+				   { dram(mips), mips.caches.dram = DramController({1, 8, 2048, true, 15, 30, 60, 4}); }),
+		  "checkpoint DRAM: rejected with other latencies");
+	check(!resumes([&](MIPS_Architecture &mips)
+				   { dram(mips), mips.caches.dram = DramController({1, 8, 2048, false, 15, 30, 45, 4}); }),
+		  "checkpoint DRAM: rejected with another page policy");
+	remove("pipeline_test.ckpt");
+}
+
+// a loop of nested data dependent branches, exits taken from its middle and a branch at the end of the program
+const std::string nestedBranches =
+	"addi $s0, $0, 3000\naddi $t1, $0, 40\n"
+	"outer:\naddi $t0, $t0, 1\nslt $t2, $t0, $t1\nbeq $t2, $0, done\naddi $t3, $0, 0\n"
+	"inner:\nadd $s1, $s1, $t3\naddi $t3, $t3, 1\nslt $t4, $t3, $t0\nbeq $t4, $0, outer\nsw $s1, 0($s0)\nlw $t5, 0($s0)\n"
+	"bne $t5, $s1, done\nslt $t4, $t3, $t1\nbne $t4, $0, inner\n"
+	"done:\nsw $t0, 4($s0)\nbeq $t0, $0, done\n";
+
+// the same with a j closing the outer loop, for the variants decoding jumps
+const std::string jumpLoop =
+	"addi $s0, $0, 3000\naddi $t1, $0, 30\n"
+	"loop:\naddi $t0, $t0, 1\nslt $t2, $t0, $t1\nbeq $t2, $0, done\nadd $s1, $s1, $t0\nsw $s1, 0($s0)\nj loop\n"
+	"done:\nsw $t0, 4($s0)\n";
+
+// fetching down a predicted path, resolving branches in ID and the BTB change the timing of a variant, never its result
+template <typename Simulator>
+void testSpeculationState(const std::string &variant, bool jumps)
+{
+	std::vector<std::pair<std::string, std::function<void(Simulator &)>>> options = {
+		{"saturating predictor", [](Simulator &mips)
+		 { mips.predictor = std::make_shared<SaturatingBranchPredictor>(0); }},
+		{"history predictor", [](Simulator &mips)
+		 { mips.predictor = std::make_shared<BHRBranchPredictor>(1); }},
+		{"per-pc history predictor", [](Simulator &mips)
+		 { mips.predictor = std::make_shared<SaturatingBHRBranchPredictor>(1, 1 << 16); }},
+		{"early branches", [](Simulator &mips)
+		 { mips.earlyBranches = true; }},
+		{"BTB", [](Simulator &mips)
+		 { mips.btb.configure(16, 2); }},
+		{"predictor, BTB and early branches", [](Simulator &mips)
+		 { mips.predictor = std::make_shared<SaturatingBranchPredictor>(0), mips.btb.configure(16, 2), mips.earlyBranches = true; }},
+		{"predictor and caches", [](Simulator &mips)
+		 { mips.predictor = std::make_shared<SaturatingBranchPredictor>(1), blockingCaches(mips); }},
+	};
+	std::vector<std::string> programs = {countedLoop, alternatingLoop, stridedLoop, nestedBranches};
+	if (jumps)
+		programs.push_back(jumpLoop);
+	for (size_t i = 0; i < programs.size(); ++i)
+	{
+		FinalState plain = run<Simulator>(programs[i], [](Simulator &) {});
+		for (auto &option : options)
+			check(run<Simulator>(programs[i], option.second) == plain,
+				  variant + " state: program " + std::to_string(i) + " with " + option.first);
+	}
+}
+
+// a j fetched from its BTB entry after a mispredicted branch is squashed and does not count as a removed bubble
+void testRemovedJumps()
+{
+	std::string program =
+		"addi $s0, $0, 3000\naddi $t1, $0, 10\n"
+		"loop:\naddi $t0, $t0, 1\nbne $t0, $t1, loop\nj end\naddi $s1, $0, 5\n"
+		"end:\nsw $t0, 0($s0)\n";
+	std::ifstream file(writeProgram(program));
+	MIPS_Architecture mips(file);
+	mips.predictor = std::make_shared<SaturatingBranchPredictor>(0);
+	mips.btb.configure(16, 2);
+	NullBuffer null;
+	std::streambuf *out = std::cout.rdbuf(&null);
+	mips.executeCommandPipelined();
+	std::cout.rdbuf(out);
+	check(mips.registers[17] == 0 && mips.btb.removed == 1, "BTB: only the retired j counts as removed");
+}
+
+int main()
+{
+	testMissFillOrder();
+	testNonBlockingMatchesBlocking();
+	testWorkTermination();
+	testWorkCaches();
+	testSpeculationState<part1::MIPS_Architecture>("final_part1", true);
+	testSpeculationState<MIPS_Architecture>("final_part2", true);
+	testSpeculationState<work::MIPS_Architecture>("work", false);
+	testCheckpointCacheGeometry();
+	testCheckpointPrefetchers();
+	testCheckpointDram();
+	testCheckpointPredictor();
+	testUserPredictor();
+	testRemovedJumps();
+	remove("pipeline_test.asm");
+	std::cout << (failures ? "FAILED\n" : "all passed\n");
+	return failures != 0;
+}
@@ -2,21 +2,26 @@
 
 int main(int argc, char *argv[])
 {
-	if (argc != 2)
+	if (argc < 2 || argc > 4)
 	{
-		std::cerr << "Required argument: file_name\n./MIPS_interpreter <file name>\n";
+		std::cerr << "Required argument: file_name\n./MIPS_interpreter <file name> [threaded|jit] [image file]\n";
 		return 0;
 	}
 	std::ifstream file(argv[1]);
 	MIPS_Architecture *mips;
 	if (file.is_open())
-		mips = new MIPS_Architecture(file);
+		mips = new MIPS_Architecture(argv[1], argc == 4 ? argv[3] : "");
 	else
 	{
 		std::cerr << "File could not be opened. Terminating...\n";
 		return 0;
 	}
 
-	mips->executeCommandsUnpipelined();
+	if (argc >= 3 && std::string(argv[2]) == "threaded")
+		mips->executeCommandsThreaded();
+	else if (argc >= 3 && std::string(argv[2]) == "jit")
+		mips->executeCommandsJIT();
+	else
+		mips->executeCommandsUnpipelined();
 	return 0;
 }